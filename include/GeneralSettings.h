@@ -5,8 +5,11 @@
 #define FIRMWARE_VERSION_PATCH 0
 
 #define PANEL_UPCYCLED 1
+// #define HIGH_REFRESH_SCAN 1  // GCLK multiplier + 13-bit greyscale, for filming the panel
+#define PIPELINED_DISPLAY 1  // encode and send frames on core 0 while core 1 renders
 
 #define RUN_DEMO 1
+// #define RUN_BENCHMARKS 1  // log rendering benchmarks at boot
 
 #define AQUARIUM_ENABLED 1
 #define SCD40_ENABLED 1
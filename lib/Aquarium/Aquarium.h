@@ -31,6 +31,7 @@ class Aquarium {
   AquariumStateManager aquariumStateManager;
   unsigned long lastSaveTime;
   char buffer[100];
+  bool showSensors = false;  // sensor read-outs on their own layer, see display()
 
   // Demo settings
   bool demoMode;
@@ -46,7 +47,7 @@ class Aquarium {
   unsigned long lastFoodTime = 0;
   const unsigned long FOOD_INTERVAL = 200; // Add food every 200ms while touched
 
-  enum class TextAlignment { LEFT, CENTER, RIGHT };
+  TextLayout textLayout;  // demo and sensor text, never shown together
 
  public:
   Aquarium(Matrix* m, SCD40* s, StateManager* stateManager)
@@ -200,8 +201,8 @@ class Aquarium {
     updatePlants();
   }
 
-  drawMultilineText(matrix->foreground, buffer, MIDDLE,
-                    TextAlignment::CENTER, &Font5x7Fixed,
+  drawMultilineText(LAYER_SENSOR, buffer, MIDDLE,
+                    TextAlign::CENTER, &Font5x7Fixed,
                     CRGB(150, 150, 150));
 }
 
@@ -374,12 +375,12 @@ class Aquarium {
                   temperature, humidity, co2);
           }
         
-        drawMultilineText(matrix->foreground, buffer, MIDDLE,
-                          TextAlignment::CENTER, &Font4x7Fixed,
+        drawMultilineText(LAYER_SENSOR, buffer, MIDDLE,
+                          TextAlign::CENTER, &Font4x7Fixed,
                           CRGB(150, 150, 150));
       } else {
-        drawMultilineText(matrix->foreground, "Sensors\nWarming Up...", MIDDLE,
-                          TextAlignment::CENTER, &Font4x7Fixed,
+        drawMultilineText(LAYER_SENSOR, "Sensors\nWarming Up...", MIDDLE,
+                          TextAlign::CENTER, &Font4x7Fixed,
                           CRGB(150, 150, 150));
       }
     }
@@ -387,6 +388,7 @@ class Aquarium {
 
   // General update function that updates all components of the aquarium
   void update(bool showSensorData = false) {
+    showSensors = showSensorData;
     handleTouchInput();
 
     if (demoMode) {
@@ -398,14 +400,20 @@ class Aquarium {
       updateFish();
       updateFood();
       updatePlants();
-      updateSensorData(showSensorData);
       periodicSave();
     }
   }
 
+  // Water, then fish and plants on top. Sensor and demo text go straight
+  // into their own compositor layer above the scene.
   void display() {
-    matrix->gfx_compositor->Stack(*matrix->background, *matrix->foreground);
+    matrix->background->display();
+    matrix->foreground->display();
     matrix->foreground->clear();
+
+    if (showSensors && !demoMode) {
+      updateSensorData(true);
+    }
   }
 
   // Destructor to clean up resources
@@ -413,67 +421,13 @@ class Aquarium {
     // Unique pointers automatically clean up
   }
 
-  void drawMultilineText(GFX_Layer* layer, const char* text,
-                         textPosition textPos, TextAlignment alignment,
+  // Laid out once per text, redrawn from the cached glyphs every frame
+  void drawMultilineText(LayerId layer, const char* text,
+                         textPosition textPos, TextAlign alignment,
                          const GFXfont* f, CRGB color) {
-    layer->setFont(f);
-    layer->setTextColor(layer->color565(color.r, color.g, color.b));
-
-    // Split text into lines
-    std::vector<String> lines;
-    String currentLine;
-    for (const char* c = text; *c; ++c) {
-      if (*c == '\n') {
-        lines.push_back(currentLine);
-        currentLine = "";
-      } else {
-        currentLine += *c;
-      }
-    }
-    if (!currentLine.isEmpty()) {
-      lines.push_back(currentLine);
-    }
-
-    // Calculate total height and maximum width
-    int16_t x1, y1;
-    uint16_t w, h, maxWidth = 0, totalHeight = 0;
-    for (const String& line : lines) {
-      layer->getTextBounds(line.c_str(), 0, 0, &x1, &y1, &w, &h);
-      maxWidth = max(maxWidth, w);
-      totalHeight += h;
-    }
-
-    // Calculate starting Y position
-    int16_t startY;
-    if (textPos == TOP) {
-      startY = h;
-    } else if (textPos == BOTTOM) {
-      startY = layer->getHeight() - totalHeight;
-    } else {  // MIDDLE
-      startY = (layer->getHeight() - totalHeight) / 2 + h;
-    }
-
-    // Draw each line
-    for (const String& line : lines) {
-      int16_t lineX;
-      layer->getTextBounds(line.c_str(), 0, 0, &x1, &y1, &w, &h);
-
-      switch (alignment) {
-        case TextAlignment::LEFT:
-          lineX = 0;
-          break;
-        case TextAlignment::CENTER:
-          lineX = (layer->getWidth() - w) / 2;
-          break;
-        case TextAlignment::RIGHT:
-          lineX = layer->getWidth() - w;
-          break;
-      }
-
-      layer->setCursor(lineX, startY);
-      layer->print(line);
-      startY += h;
-    }
+    textLayout.set(text, f, textPos, alignment, matrix->getXResolution(),
+                   matrix->getYResolution());
+    textLayout.draw(matrix->compositor, layer, color);
   }
 };
 
@@ -54,7 +54,8 @@ void drawSegment(uint8_t i, PVector vin, uint8_t r, uint8_t g, uint8_t b, bool d
     } else {
         // Add null check for matrix pointer
         if (matrix != nullptr && matrix->foreground != nullptr) {
-            matrix->foreground->fillCircle(segmentPositions[i].x, segmentPositions[i].y, currentSegmentSize, CRGB(r, g, b));
+            matrix->raster(LAYER_SCENE).fillCircleAA(toFixed(segmentPositions[i].x), toFixed(segmentPositions[i].y),
+                                                     toFixed(currentSegmentSize), CRGB(r, g, b));
         }
     }
 }
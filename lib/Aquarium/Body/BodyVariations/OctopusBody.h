@@ -66,9 +66,9 @@ public:
 
         CRGB segmentColor = colorPalette->colors[j + 1];
         
-        matrix->foreground->drawLine(current.x, current.y, 
-                                     tentacleSegments[i][j].x, tentacleSegments[i][j].y, 
-                                     segmentColor);
+        matrix->raster(LAYER_SCENE).drawLineAA(toFixed(current.x), toFixed(current.y),
+                                               toFixed(tentacleSegments[i][j].x),
+                                               toFixed(tentacleSegments[i][j].y), segmentColor);
         
         current = tentacleSegments[i][j];
     }
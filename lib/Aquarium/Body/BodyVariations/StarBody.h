@@ -35,6 +35,7 @@ class StarBody : public Body {
     starAngle = fmod(starAngle, TWO_PI);
     if (starAngle < 0) starAngle += TWO_PI;
 
+    Rasterizer raster = matrix->raster(LAYER_SCENE);
     if (nodes) {
       // Node-based star
       for (int i = 0; i < arms; i++) {
@@ -44,21 +45,21 @@ class StarBody : public Body {
         PVector endPoint = pos + armPt;
         
         // Draw arm
-        matrix->foreground->drawLine(
-            pos.x, pos.y, endPoint.x, endPoint.y,
+        raster.drawLineAA(
+            toFixed(pos.x), toFixed(pos.y), toFixed(endPoint.x), toFixed(endPoint.y),
             CRGB(colorPalette->colors[0].r, colorPalette->colors[0].g,
                 colorPalette->colors[0].b));
         
         // Draw node at arm end
-        matrix->foreground->fillCircle(
-            endPoint.x, endPoint.y, max(1, int(rad * 0.5 * size)),
+        raster.fillCircleAA(
+            toFixed(endPoint.x), toFixed(endPoint.y), toFixed(max(1, int(rad * 0.5 * size))),
             CRGB(colorPalette->colors[1].r, colorPalette->colors[1].g,
                 colorPalette->colors[1].b));
       }
       
       // Draw center
-      matrix->foreground->fillCircle(
-          pos.x, pos.y, max(1, int(rad * 0.5 * size)),
+      raster.fillCircleAA(
+          toFixed(pos.x), toFixed(pos.y), toFixed(max(1, int(rad * 0.5 * size))),
           CRGB(colorPalette->colors[2].r, colorPalette->colors[2].g,
               colorPalette->colors[2].b));
     } else {
@@ -82,8 +83,8 @@ class StarBody : public Body {
       }
       
       // Draw center
-      matrix->foreground->fillCircle(
-          pos.x, pos.y, max(1, int(rad * 0.5 * size)),
+      raster.fillCircleAA(
+          toFixed(pos.x), toFixed(pos.y), toFixed(max(1, int(rad * 0.5 * size))),
           CRGB(colorPalette->colors[2].r, colorPalette->colors[2].g,
               colorPalette->colors[2].b));
     }
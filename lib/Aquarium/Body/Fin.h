@@ -62,16 +62,17 @@ public:
   void display(PVector pos, float angle, uint8_t size, uint8_t r, uint8_t g, uint8_t b) override {
     // PVector heading = PVector::fromAngle(angle);
     // heading *= 0.5;
+    Rasterizer raster = matrix->raster(LAYER_SCENE);
     PVector pt = PVector::fromAngle(angle + PI/2);
     pt.setMag(size*2);
     // pt += heading;
     pt += pos;
-    matrix->foreground->drawLine(pt.x, pt.y, pos.x, pos.y, CRGB(r, g, b));
+    raster.drawLineAA(toFixed(pt.x), toFixed(pt.y), toFixed(pos.x), toFixed(pos.y), CRGB(r, g, b));
     pt = PVector::fromAngle(angle + PI/2);
     pt.setMag(-size*2);
     // pt += heading;
     pt += pos;
-    matrix->foreground->drawLine(pt.x, pt.y, pos.x, pos.y, CRGB(r, g, b));
+    raster.drawLineAA(toFixed(pt.x), toFixed(pt.y), toFixed(pos.x), toFixed(pos.y), CRGB(r, g, b));
   }
 };
 
@@ -84,18 +85,19 @@ public:
   void display(PVector pos, float angle, uint8_t size, uint8_t r, uint8_t g, uint8_t b) override {
     // PVector heading = PVector::fromAngle(angle);
     // heading *= 0.5;
+    Rasterizer raster = matrix->raster(LAYER_SCENE);
     PVector pt = PVector::fromAngle(angle + PI/2);
     pt.setMag(size*2);
     // pt += heading;
     pt += pos;
-    matrix->foreground->drawLine(pt.x, pt.y, pos.x, pos.y, CRGB(r, g, b));
-    matrix->foreground->fillCircle(pt.x, pt.y, size/3, CRGB(b, g, r));
+    raster.drawLineAA(toFixed(pt.x), toFixed(pt.y), toFixed(pos.x), toFixed(pos.y), CRGB(r, g, b));
+    raster.fillCircleAA(toFixed(pt.x), toFixed(pt.y), toFixed(size/3), CRGB(b, g, r));
     pt = PVector::fromAngle(angle + PI/2);
     pt.setMag(-size*2);
     // pt += heading;
     pt += pos;
-    matrix->foreground->drawLine(pt.x, pt.y, pos.x, pos.y, CRGB(r, g, b));
-    matrix->foreground->fillCircle(pt.x, pt.y, size/3, CRGB(b, g, r));
+    raster.drawLineAA(toFixed(pt.x), toFixed(pt.y), toFixed(pos.x), toFixed(pos.y), CRGB(r, g, b));
+    raster.fillCircleAA(toFixed(pt.x), toFixed(pt.y), toFixed(size/3), CRGB(b, g, r));
   }
 };
 
@@ -55,12 +55,13 @@ public:
     pt.setMag(size);
     pt += heading;
     pt += position;
-    matrix->foreground->fillCircle(pt.x, pt.y, size/2, CRGB(b, g, r));
+    Rasterizer raster = matrix->raster(LAYER_SCENE);
+    raster.fillCircleAA(toFixed(pt.x), toFixed(pt.y), toFixed(size/2), CRGB(b, g, r));
     pt = PVector::fromAngle(angle + PI/2);
     pt.setMag(-size);
     pt += heading;
     pt += position;
-    matrix->foreground->fillCircle(pt.x, pt.y, size/2, CRGB(b, g, r));
+    raster.fillCircleAA(toFixed(pt.x), toFixed(pt.y), toFixed(size/2), CRGB(b, g, r));
   }
 };
 
@@ -75,7 +76,8 @@ public:
     PVector pt1 = PVector::fromAngle(angle);
     pt1 *= size * noseLengthMultiplier;
     pt1 += position;
-    matrix->foreground->drawLine(pt1.x, pt1.y, position.x, position.y, CRGB(r,g,b));
+    matrix->raster(LAYER_SCENE).drawLineAA(toFixed(pt1.x), toFixed(pt1.y), toFixed(position.x),
+                                           toFixed(position.y), CRGB(r,g,b));
   }
 };
 
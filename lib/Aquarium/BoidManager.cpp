@@ -33,6 +33,7 @@ void BoidManager::updateBoids(long co2) {
 }
 
 void BoidManager::renderBoids() {
+  Rasterizer raster = matrix->raster(LAYER_SCENE);
   for (const auto& group : boidGroups) {
     for (const auto& boid : group) {
       // Calculate the second point of the line
@@ -41,7 +42,8 @@ void BoidManager::renderBoids() {
       int y2 = boid.location.y + sin(angle);
 
       // Draw the line
-      matrix->foreground->drawLine(boid.location.x, boid.location.y, x2, y2, CRGB(50, 200, 100));
+      raster.drawLineAA(toFixed(boid.location.x), toFixed(boid.location.y), toFixed(x2), toFixed(y2),
+                        CRGB(50, 200, 100));
     }
   }
 }
\ No newline at end of file
@@ -47,6 +47,7 @@ class Plants {
     float sizeFactor = map(humidity, 0, 100, 0, 250);
     sizeFactor /= 100;
 
+    Rasterizer raster = matrix->raster(LAYER_SCENE);
     for (uint8_t i = 0; i < branches.size(); i++) {
       matrix->foreground->drawLine(branches[i].nodes[0].x * sizeFactor + pos.x, branches[i].nodes[0].y * sizeFactor + pos.y, pos.x, pos.y, CRGB(0, 0, 0));
       // matrix->background->drawLine(branches[i].nodes[0].x * sizeFactor + pos.x, branches[i].nodes[0].y * sizeFactor + pos.y, pos.x, pos.y, CRGB(0, 0, 0));
@@ -60,7 +61,7 @@ class Plants {
 
         // Apply sway to x coordinates
         // matrix->background->drawLine(prevNode.x * sizeFactor + sway + pos.x, prevNode.y * sizeFactor + pos.y, node.x * sizeFactor + sway + pos.x, node.y * sizeFactor + pos.y, CRGB(0,0,1));
-        matrix->foreground->drawLine(prevNode.x * sizeFactor + sway + pos.x, prevNode.y * sizeFactor + pos.y, node.x * sizeFactor + sway + pos.x, node.y * sizeFactor + pos.y, CRGB(0,0,1));
+        raster.drawLineAA(toFixed(prevNode.x * sizeFactor + sway + pos.x), toFixed(prevNode.y * sizeFactor + pos.y), toFixed(node.x * sizeFactor + sway + pos.x), toFixed(node.y * sizeFactor + pos.y), CRGB(0,0,1));
         
         // Flower at the end of the branch
         if(j == branches[i].nodes.size()-1){
@@ -68,7 +69,7 @@ class Plants {
           if(glowFactor > 0) {
             uint8_t glowIntensity = static_cast<uint8_t>(glowFactor * 1000); // Scale to color intensity
             // matrix->background->fillCircle(node.x * sizeFactor + sway + pos.x, node.y * sizeFactor + pos.y, 1, CRGB(glowIntensity, glowIntensity, 0));
-            matrix->foreground->fillCircle(node.x * sizeFactor + sway + pos.x, node.y * sizeFactor + pos.y, 1, CRGB(glowIntensity, glowIntensity, 0));
+            raster.fillCircleAA(toFixed(node.x * sizeFactor + sway + pos.x), toFixed(node.y * sizeFactor + pos.y), toFixed(1), CRGB(glowIntensity, glowIntensity, 0));
           }
         }
       }
@@ -13,6 +13,7 @@ private:
   CRGBPalette16 palette;
 
   CRGB** updateBuffer = nullptr;
+  uint8_t* noiseRow = nullptr;
   size_t currentRow = 0;
   static const size_t rowsPerUpdate = 8;
   size_t totalRows = matrix->getYResolution();
@@ -45,6 +46,7 @@ public:
     for (size_t i = 0; i < matrix->getYResolution(); i++) {
       updateBuffer[i] = new CRGB[matrix->getXResolution()];
     }
+    noiseRow = new uint8_t[matrix->getXResolution()];
   }
 
   ~Water() {
@@ -53,6 +55,7 @@ public:
       delete[] updateBuffer[i];
     }
     delete[] updateBuffer;
+    delete[] noiseRow;
   }
 
 
@@ -79,9 +82,11 @@ public:
     simplexColor = ColorFromPalette(palette, colorIndex, 255, LINEARBLEND);
     
     // Update a portion of the buffer
+    uint16_t time = millis() * simplexSpeed;
     for (size_t row = currentRow; row < currentRow + rowsPerUpdate && row < totalRows; ++row) {
+      inoise8Row(noiseRow, matrix->getXResolution(), 0, scale, row * scale, time);
       for (size_t col = 0; col < matrix->getXResolution(); ++col) {
-        uint8_t noiseFactor = inoise8(col * scale, row * scale, (millis() * simplexSpeed));
+        uint8_t noiseFactor = noiseRow[col];
         if (noiseFactor < 96) noiseFactor = 96; // keep cold from going near-black
         CRGB color = simplexColor;
         color.nscale8(noiseFactor);
@@ -0,0 +1,843 @@
+#include "Benchmark.h"
+
+#include <FastNoise.h>
+#include <LifeWorld.h>
+#include <LSystemEffect.h>
+#include <Fonts/Font4x7Fixed.h>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifdef PANEL_UPCYCLED
+#include "MBI5153/UMatrix.h"
+#include "MBI5153/mbi_emulator.hpp"
+#else
+#include "Original/OMatrix.h"
+#endif
+
+// Deterministic test pattern so both sides of a comparison see the same pixels
+static inline uint8_t patternValue(uint16_t x, uint16_t y, uint8_t channel) {
+  uint32_t h = (x * 73856093u) ^ (y * 19349663u) ^ (channel * 83492791u);
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  return h >> 24;
+}
+
+void Benchmark::run(Matrix* matrix) {
+  log_i("=== Benchmarks ===");
+#ifdef PANEL_UPCYCLED
+  frameEncoder(*static_cast<UMatrix*>(matrix));
+  emulatedOutput(*static_cast<UMatrix*>(matrix));
+  framePipeline(*static_cast<UMatrix*>(matrix));
+  pixelSink(*static_cast<UMatrix*>(matrix));
+#else
+  hub75Frame(*static_cast<OMatrix*>(matrix));
+#endif
+  rasterizer(*matrix);
+  text(*matrix);
+  noise(*matrix);
+  fastNoise(*matrix);
+  life(*matrix);
+  lsystem(*matrix);
+  log_i("==================");
+}
+
+// Roughly one aquarium frame: fish segments, fins and flowers as circles,
+// boids, plant strokes and fin lines as lines, some of them partly off the
+// panel. Drawn through the GFX layer (plus the display() that brings it into
+// the compositor) and through the span rasterizer, which must set the same
+// pixels, then through the anti-aliased primitives the aquarium uses.
+void Benchmark::rasterizer(Matrix& m) {
+  struct Circle { float x, y, r; CRGB c; };
+  struct Line { float x0, y0, x1, y1; CRGB c; };
+  const int circleCount = 120;
+  const int lineCount = 160;
+  Circle* circles = new Circle[circleCount];
+  Line* lines = new Line[lineCount];
+
+  const float w = m.getXResolution();
+  const float h = m.getYResolution();
+  for (int i = 0; i < circleCount; i++) {
+    circles[i].x = patternValue(i, 0, 0) * (w + 8) / 256.0f - 4;
+    circles[i].y = patternValue(i, 0, 1) * (h + 8) / 256.0f - 4;
+    circles[i].r = 1 + patternValue(i, 0, 2) % 4;
+    circles[i].c = CRGB(patternValue(i, 1, 0) | 1, patternValue(i, 1, 1), 40);
+  }
+  for (int i = 0; i < lineCount; i++) {
+    float len = 1 + patternValue(i, 2, 0) % 6;
+    float angle = patternValue(i, 2, 1) * TWO_PI / 256.0f;
+    lines[i].x0 = patternValue(i, 3, 0) * (w + 4) / 256.0f - 2;
+    lines[i].y0 = patternValue(i, 3, 1) * (h + 4) / 256.0f - 2;
+    lines[i].x1 = lines[i].x0 + cos(angle) * len;
+    lines[i].y1 = lines[i].y0 + sin(angle) * len;
+    lines[i].c = CRGB(50, patternValue(i, 4, 0) | 1, 100);
+  }
+
+  m.foreground->clear();
+  m.compositor.clearAll();
+
+  unsigned long start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < circleCount; i++) {
+      m.foreground->fillCircle(circles[i].x, circles[i].y, circles[i].r, circles[i].c);
+    }
+  }
+  unsigned long gfxCirclesUs = micros() - start;
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < lineCount; i++) {
+      m.foreground->drawLine(lines[i].x0, lines[i].y0, lines[i].x1, lines[i].y1, lines[i].c);
+    }
+  }
+  unsigned long gfxLinesUs = micros() - start;
+  start = micros();
+  m.displayInto(m.foreground, LAYER_OVERLAY);
+  unsigned long displayUs = micros() - start;
+
+  Rasterizer raster = m.raster(LAYER_SCENE);
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < circleCount; i++) {
+      raster.fillCircle(toFixed(circles[i].x), toFixed(circles[i].y), toFixed(circles[i].r),
+                        circles[i].c);
+    }
+  }
+  unsigned long spanCirclesUs = micros() - start;
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < lineCount; i++) {
+      raster.drawLine(toFixed(lines[i].x0), toFixed(lines[i].y0), toFixed(lines[i].x1),
+                      toFixed(lines[i].y1), lines[i].c);
+    }
+  }
+  unsigned long spanLinesUs = micros() - start;
+
+  uint32_t mismatches = 0;
+  for (int16_t y = 0; y < h; y++) {
+    for (int16_t x = 0; x < w; x++) {
+      CRGB a = m.compositor.getPixel(LAYER_OVERLAY, x, y);
+      CRGB b = m.compositor.getPixel(LAYER_SCENE, x, y);
+      if (a.r != b.r || a.g != b.g || a.b != b.b) {
+        mismatches++;
+      }
+    }
+  }
+
+  m.foreground->clear();
+  m.compositor.clearAll();
+
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < circleCount; i++) {
+      raster.fillCircleAA(toFixed(circles[i].x), toFixed(circles[i].y), toFixed(circles[i].r),
+                          circles[i].c);
+    }
+  }
+  unsigned long aaCirclesUs = micros() - start;
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int i = 0; i < lineCount; i++) {
+      raster.drawLineAA(toFixed(lines[i].x0), toFixed(lines[i].y0), toFixed(lines[i].x1),
+                        toFixed(lines[i].y1), lines[i].c);
+    }
+  }
+  unsigned long aaLinesUs = micros() - start;
+  m.compositor.clearAll();
+
+  // No GFX reference for those: a white disc's coverage, summed over its
+  // pixels, has to come out as its area instead
+  const fix_t discR = toFixed(4.6f);
+  raster.fillCircleAA(toFixed(20.3f), toFixed(30.7f), discR, CRGB(255, 255, 255));
+  float covered = 0;
+  for (int16_t y = 0; y < h; y++) {
+    for (int16_t x = 0; x < w; x++) {
+      covered += m.compositor.getPixel(LAYER_SCENE, x, y).r / 255.0f;
+    }
+  }
+  m.compositor.clearAll();
+  float discRadius = discR / (float)(1 << RASTER_FRAC_BITS) + 0.5f;
+  float discArea = PI * discRadius * discRadius;
+
+  delete[] circles;
+  delete[] lines;
+
+  const float calls = ITERATIONS;
+  log_i("Raster circles: GFX %.2f us, spans %.2f us per circle", gfxCirclesUs / (calls * circleCount),
+        spanCirclesUs / (calls * circleCount));
+  log_i("Raster lines: GFX %.2f us, spans %.2f us per line", gfxLinesUs / (calls * lineCount),
+        spanLinesUs / (calls * lineCount));
+  log_i("Raster frame (%d circles, %d lines): GFX %.0f us + display %lu us, spans %.0f us, %s",
+        circleCount, lineCount, (gfxCirclesUs + gfxLinesUs) / calls, displayUs,
+        (spanCirclesUs + spanLinesUs) / calls,
+        mismatches ? "pixels DIFFER" : "same pixels");
+  if (mismatches) {
+    log_e("Rasterizer: %u pixels differ from GFX_Layer", mismatches);
+  }
+
+  float aaFrameUs = (aaCirclesUs + aaLinesUs) / calls;
+  log_i("Raster AA: %.2f us per circle, %.2f us per line, frame %.0f us (%.0f%% of 30 FPS)",
+        aaCirclesUs / (calls * circleCount), aaLinesUs / (calls * lineCount), aaFrameUs,
+        aaFrameUs * 100 / 33333.0f);
+  log_i("Raster AA disc: %.2f of %.2f pixels covered", covered, discArea);
+  if (fabs(covered - discArea) > discArea * 0.03f) {
+    log_e("Rasterizer: AA disc coverage off by more than 3%%");
+  }
+}
+
+// The aquarium's sensor text as it was drawn every frame: split into Strings,
+// measured with getTextBounds() and printed through the GFX layer. Against a
+// TextLayout laid out once and blitted from the glyph atlas, which must set
+// the same pixels.
+void Benchmark::text(Matrix& m) {
+  const char* text = "\nTemp: 21.5 C\nHumidity: 45 %\nCO2: 812 ppm";
+  const GFXfont* font = &Font4x7Fixed;
+  const int16_t w = m.getXResolution();
+  const int16_t h = m.getYResolution();
+  GFX_Layer* layer = m.foreground;
+
+  layer->clear();
+  m.compositor.clearAll();
+
+  unsigned long start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    layer->setFont(font);
+    std::vector<String> lines;
+    String currentLine;
+    for (const char* c = text; *c; ++c) {
+      if (*c == '\n') {
+        lines.push_back(currentLine);
+        currentLine = "";
+      } else {
+        currentLine += *c;
+      }
+    }
+    if (!currentLine.isEmpty()) {
+      lines.push_back(currentLine);
+    }
+
+    int16_t x1, y1;
+    uint16_t lineW, lineH, totalHeight = 0;
+    for (const String& line : lines) {
+      layer->getTextBounds(line.c_str(), 0, 0, &x1, &y1, &lineW, &lineH);
+      totalHeight += lineH;
+    }
+    int16_t y = (h - totalHeight) / 2 + lineH;
+    for (const String& line : lines) {
+      layer->getTextBounds(line.c_str(), 0, 0, &x1, &y1, &lineW, &lineH);
+      layer->setCursor((w - lineW) / 2, y);
+      layer->print(line);
+      y += lineH;
+    }
+  }
+  unsigned long gfxUs = (micros() - start) / ITERATIONS;
+  start = micros();
+  m.displayInto(layer, LAYER_OVERLAY);
+  unsigned long displayUs = micros() - start;
+  layer->clear();
+
+  TextLayout layout;
+  start = micros();
+  layout.set(text, font, MIDDLE, TextAlign::CENTER, w, h);
+  unsigned long layoutUs = micros() - start;
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    layout.set(text, font, MIDDLE, TextAlign::CENTER, w, h);
+    layout.draw(m.compositor, LAYER_SENSOR, CRGB(150, 150, 150));
+  }
+  float cachedUs = (micros() - start) / (float)ITERATIONS;
+
+  uint32_t mismatches = 0;
+  for (int16_t y = 0; y < h; y++) {
+    for (int16_t x = 0; x < w; x++) {
+      CRGB a = m.compositor.getPixel(LAYER_OVERLAY, x, y);
+      CRGB b = m.compositor.getPixel(LAYER_SENSOR, x, y);
+      if ((bool)(a.r | a.g | a.b) != (bool)(b.r | b.g | b.b)) {
+        mismatches++;
+      }
+    }
+  }
+  m.compositor.clearAll();
+
+  log_i("Text (%u glyphs): GFX %lu us + display %lu us per frame, layout %lu us once, cached %.1f us per frame, %s",
+        layout.glyphCount(), gfxUs, displayUs, layoutUs, cachedUs,
+        mismatches ? "pixels DIFFER" : "same pixels");
+  if (mismatches) {
+    log_e("Text layout: %u pixels differ from GFX_Layer", mismatches);
+  }
+}
+
+// A NoiseEffect frame, scale 15, sample by sample through FastLED's inoise8()
+// and a row at a time through inoise8Tile(). That the two agree is checked
+// on the host, see test/test_noise8.
+void Benchmark::noise(Matrix& m) {
+  const uint16_t w = m.getXResolution();
+  const uint16_t h = m.getYResolution();
+  const uint16_t scale = 15;
+  const uint32_t pixels = (uint32_t)w * h;
+  std::vector<uint8_t> frame(pixels);
+
+  unsigned long start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (uint16_t y = 0; y < h; y++) {
+      for (uint16_t x = 0; x < w; x++) {
+        frame[y * w + x] = inoise8(x * scale, y * scale, n * 100);
+      }
+    }
+  }
+  unsigned long scalarUs = micros() - start;
+
+  start = micros();
+  for (int n = 0; n < ITERATIONS; n++) {
+    inoise8Tile(frame.data(), w, w, h, 0, scale, 0, scale, n * 100);
+  }
+  unsigned long tileUs = micros() - start;
+
+  log_i("Noise (%ux%u): inoise8 %.0f px/ms, rows %.0f px/ms (%.1fx)", w, h,
+        pixels * ITERATIONS * 1000.0f / scalarUs, pixels * ITERATIONS * 1000.0f / tileUs,
+        (float)scalarUs / tileUs);
+}
+
+// A frame of each FastNoiseLite noise type as the noise effects sample it (3D,
+// frequency .04, one sample per pixel), point by point with GetNoise() and as
+// a lattice with GetNoiseGrid(), into floats and into Q15. How close the grid
+// stays to GetNoise() is checked on the host, see test/test_fast_noise.
+void Benchmark::fastNoise(Matrix& m) {
+  static const char* names[] = {"OpenSimplex2", "OpenSimplex2S", "Cellular",
+                                "Perlin",       "ValueCubic",    "Value"};
+  const int w = m.getXResolution();
+  const int h = m.getYResolution();
+  const uint32_t pixels = (uint32_t)w * h;
+  std::vector<float> frame(pixels);
+  std::vector<int16_t> fixed(pixels);
+
+  FastNoiseLite noise;
+  noise.SetFrequency(.04);
+  for (int type = 0; type < 6; type++) {
+    noise.SetNoiseType((FastNoiseLite::NoiseType)type);
+    const float z = 12.5f;
+
+    unsigned long start = micros();
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        frame[y * w + x] = noise.GetNoise((float)x, (float)y, z);
+      }
+    }
+    unsigned long scalarUs = micros() - start;
+
+    start = micros();
+    noise.GetNoiseGrid(frame.data(), w, h, w, 0.0f, 0.0f, z, 1.0f, 1.0f);
+    unsigned long gridUs = micros() - start;
+
+    start = micros();
+    noise.GetNoiseGrid(fixed.data(), w, h, w, 0.0f, 0.0f, z, 1.0f, 1.0f);
+    unsigned long fixedUs = micros() - start;
+
+    log_i("FastNoise %s: GetNoise %.0f px/ms, grid %.0f px/ms (%.2fx), Q15 %.0f px/ms",
+          names[type], pixels * 1000.0f / scalarUs, pixels * 1000.0f / gridUs,
+          (float)scalarUs / gridUs, pixels * 1000.0f / fixedUs);
+  }
+}
+
+// LifeWorld on the panel sized torus and on a world of 4 x 4 panels, for
+// Conway's rule and Brian's Brain. Cell updates per second, not counting
+// display; test/test_life_world checks the generations themselves.
+void Benchmark::life(Matrix& m) {
+  const int w = m.getXResolution();
+  const int h = m.getYResolution();
+  const int generations = 50;
+
+  LifeWorld world;
+  world.resize(w, h);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      world.set(x, y, patternValue(x, y, 0) < 128);
+    }
+  }
+  unsigned long start = micros();
+  world.step(generations);
+  unsigned long panelUs = micros() - start;
+  float updates = (float)w * h * generations;
+
+  LifeWorld large;
+  large.resize(w * 4, h * 4);
+  for (int y = 0; y < large.height(); y++) {
+    for (int x = 0; x < large.width(); x++) {
+      large.set(x, y, patternValue(x, y, 1) < 100);
+    }
+  }
+  start = micros();
+  large.step(generations);
+  unsigned long largeUs = micros() - start;
+  float largeUpdates = (float)large.width() * large.height() * generations;
+
+  LifeWorld::Rule brain;
+  LifeWorld::parseRule("B2/S/C3", brain);
+  large.setRule(brain);
+  start = micros();
+  large.step(generations);
+  unsigned long brainUs = micros() - start;
+
+  log_i("Life %dx%d: %.2f M updates/s", w, h, updates / panelUs);
+  log_i("Life %ux%u: %.2f M updates/s, Brian's Brain %.2f M updates/s",
+        large.width(), large.height(), largeUpdates / largeUs, largeUpdates / brainUs);
+}
+
+// LSystemEffect before its ops: the whole word rewritten generation by
+// generation, then read character by character every frame
+namespace {
+struct WordLSystem {
+  struct Rule {
+    const char* rule;
+    float prob;
+  };
+  const std::vector<Rule> xRules = {{"F[+X][-X]FX", 0.5},  {"F[-X]FX", 0.05},
+                                    {"F[+X]FX", 0.05},     {"F[++X][-X]FX", 0.1},
+                                    {"F[+X][--X]FX", 0.1}, {"F[+X][-X]FXA", 0.1},
+                                    {"F[+X][-X]FXB", 0.1}};
+  const std::vector<Rule> fRules = {{"FF", 0.85}, {"FFF", 0.05}, {"F", 0.1}};
+  std::string word = "X";
+
+  std::string chooseOne(const std::vector<Rule>& ruleSet) {
+    float n = static_cast<float>(random(100)) / 100.0f;
+    float t = 0;
+    for (const auto& rule : ruleSet) {
+      t += rule.prob;
+      if (t > n) {
+        return rule.rule;
+      }
+    }
+    return "";
+  }
+
+  void generate() {
+    std::string next = "";
+    for (char c : word) {
+      if (c == 'X')
+        next += chooseOne(xRules);
+      else if (c == 'F')
+        next += chooseOne(fRules);
+      else
+        next += c;
+    }
+    word = next;
+  }
+
+  void draw(Rasterizer& raster, int x, int y, float scale) {
+    const float len = 1.0f;
+    float angle = -M_PI / 2;
+    std::vector<std::tuple<int, int, float>> stack;
+    const float subPixelScale = 4.0f;
+    float subX = x * subPixelScale;
+    float subY = y * subPixelScale;
+    for (char c : word) {
+      switch (c) {
+        case 'F': {
+          float newSubX = subX + cos(angle) * len * subPixelScale * scale;
+          float newSubY = subY + sin(angle) * len * subPixelScale * scale;
+          raster.drawLine(toFixed(subX / subPixelScale), toFixed(subY / subPixelScale),
+                          toFixed(newSubX / subPixelScale), toFixed(newSubY / subPixelScale),
+                          CRGB(158, 169, 63));
+          subX = newSubX;
+          subY = newSubY;
+        } break;
+        case '+':
+          angle -= M_PI / 4 * scale;
+          break;
+        case '-':
+          angle += M_PI / 4 * scale;
+          break;
+        case '[':
+          stack.push_back({subX, subY, angle});
+          break;
+        case ']':
+          if (!stack.empty()) {
+            std::tie(subX, subY, angle) = stack.back();
+            stack.pop_back();
+          }
+          break;
+        case 'A':
+        case 'B':
+          raster.fillCircle(toFixed(subX / subPixelScale), toFixed(subY / subPixelScale),
+                            toFixed(len * scale), c == 'A' ? CRGB(229, 206, 220)
+                                                           : CRGB(252, 161, 125));
+          break;
+      }
+    }
+  }
+};
+}  // namespace
+
+// For 5 to 8 generations: what building the word took against compiling the
+// ops (time and bytes held), and a fully grown frame drawn from each. The two
+// grow different random trees, so segment counts are logged alongside.
+void Benchmark::lsystem(Matrix& m) {
+  const int frames = 5;
+  LSystemEffect effect(&m);
+  Rasterizer raster = m.raster(LAYER_BACKGROUND);
+
+  for (uint8_t generations = 5; generations <= 8; generations++) {
+    WordLSystem old;
+    unsigned long start = micros();
+    for (uint8_t g = 0; g < generations; g++) {
+      old.generate();
+    }
+    unsigned long wordUs = micros() - start;
+    uint32_t oldSegments = std::count(old.word.begin(), old.word.end(), 'F');
+
+    start = micros();
+    for (int i = 0; i < frames; i++) {
+      m.background->clear();
+      old.draw(raster, m.getXResolution() / 2, m.getYResolution() - 1, 1.0f);
+    }
+    unsigned long wordDrawUs = (micros() - start) / frames;
+
+    effect.setGenerations(generations);
+    const LSystemEffect::Stats& stats = effect.getStats();
+    effect.setGrowth(1.0f);
+    start = micros();
+    for (int i = 0; i < frames; i++) {
+      effect.update();
+    }
+    unsigned long opsDrawUs = (micros() - start) / frames;
+
+    log_i("LSystem %u generations: word %lu us, %u bytes, %u F, frame %lu us", generations,
+          wordUs, (unsigned)old.word.capacity(), oldSegments, wordDrawUs);
+    log_i("LSystem %u generations: ops %lu us, %u of them in %u bytes, %u segments, "
+          "%u flowers, frame %lu us",
+          stats.generations, stats.compileUs, stats.ops, stats.arenaBytes, stats.segments,
+          stats.flowers, opsDrawUs);
+    if (stats.generations != generations) {
+      log_e("LSystem: %u generations didn't fit the ops arena", generations);
+    }
+  }
+  m.compositor.clearAll();
+}
+
+#ifdef PANEL_UPCYCLED
+void Benchmark::frameEncoder(UMatrix& m) {
+  const size_t words = m.dma_grey_buffer_parallel_bit_length;
+  ESP32_GREY_DMA_STORAGE_TYPE* scratch =
+      (ESP32_GREY_DMA_STORAGE_TYPE*)heap_caps_calloc(
+          words, sizeof(ESP32_GREY_DMA_STORAGE_TYPE), MALLOC_CAP_INTERNAL);
+  if (scratch == nullptr) {
+    log_e("Frame encoder benchmark: not enough memory");
+    return;
+  }
+
+  m.mbi_update_colour_lut();
+
+  // Per-pixel path, temporarily pointed at the scratch buffer
+  ESP32_GREY_DMA_STORAGE_TYPE* live = m.dma_grey_gpio_data;
+  m.dma_grey_gpio_data = scratch;
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    for (uint16_t y = 0; y < m.geometry.res_y; y++) {
+      for (uint16_t x = 0; x < m.geometry.res_x; x++) {
+        m.mbi_set_pixel(x, y, patternValue(x, y, 0), patternValue(x, y, 1),
+                        patternValue(x, y, 2));
+      }
+    }
+  }
+  unsigned long perPixelUs = (micros() - start) / ITERATIONS;
+  m.dma_grey_gpio_data = live;
+
+  // Bulk path through the framebuffer
+  for (uint16_t y = 0; y < m.geometry.res_y; y++) {
+    for (uint16_t x = 0; x < m.geometry.res_x; x++) {
+      m.mbi_store_pixel(x, y, patternValue(x, y, 0), patternValue(x, y, 1),
+                        patternValue(x, y, 2));
+    }
+  }
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.encoder.encode((const uint8_t*)m.framebuffer, scratch);
+  }
+  unsigned long bulkUs = (micros() - start) / ITERATIONS;
+  m.clearScreen();
+
+  log_i("Frame encoder: per-pixel %lu us, bulk %lu us per frame", perPixelUs, bulkUs);
+
+  free(scratch);
+}
+#endif
+
+#ifdef PANEL_UPCYCLED
+// Everything UMatrix sends over the LCD bus goes through a model of the panel,
+// and what the model's LEDs show is compared against the pattern drawn, for
+// every rotation and mirror mode. Independent of the encoder and address map:
+// only the drawing transform and the colour LUT are taken from UMatrix.
+void Benchmark::emulatedOutput(UMatrix& m) {
+  MBI_Emulator* emulator = new MBI_Emulator(m.geometry);
+
+  bool wasPipelined = m.isPipelined();
+  m.setPipelined(false);  // frames have to be on the panel when update() returns
+  m.mbi_finish_frame();
+  m.dma_bus.set_transfer_tap(MBI_Emulator::busTap, emulator);
+
+  // Config register 1 as the chips see it
+  m.refreshMatrixConfig();
+  bool configOk = emulator->configConsistent() &&
+                  emulator->configReg1() == m.mbi_config_reg1_value();
+  bool gclkOk = emulator->checkGclkPayload(
+      spi_get_payload(), spi_get_payload_size(), spi_get_gclks_per_row());
+
+  uint8_t savedRotation = m.rotation;
+  bool savedMirrorX = m.mirror_x, savedMirrorY = m.mirror_y;
+  size_t mismatches = 0;
+  unsigned long frameUs = 0;
+  int frames = 0;
+
+  for (int mode = 0; mode < 8; mode++) {
+    m.setMirror(mode & 4, false);
+    m.setRotation(mode & 3);
+
+    for (uint16_t y = 0; y < m.geometry.res_y; y++) {
+      for (uint16_t x = 0; x < m.geometry.res_x; x++) {
+        m.mbi_store_pixel(x, y, patternValue(x, y, mode), patternValue(x, y, mode + 1),
+                          patternValue(x, y, mode + 2));
+      }
+    }
+
+    unsigned long start = micros();
+    m.update();
+    m.holdFrame();  // a still picture: nothing more is sent, it has to show anyway
+    frameUs += micros() - start;
+    m.mbi_finish_frame();
+    frames++;
+
+    for (int16_t y = 0; y < m.geometry.res_y; y++) {
+      for (int16_t x = 0; x < m.geometry.res_x; x++) {
+        int16_t px = m.mirror_x ? m.geometry.res_x - 1 - x : x;
+        int16_t py = y;
+        int16_t w = m.geometry.res_x, h = m.geometry.res_y;
+        m.transform(px, py, w, h);
+        if (px < 0 || py < 0 || px >= m.geometry.res_x || py >= m.geometry.res_y) {
+          continue;
+        }
+
+        uint8_t value[3] = {patternValue(x, y, mode), patternValue(x, y, mode + 1),
+                            patternValue(x, y, mode + 2)};
+        for (int c = 0; c < 3; c++) {
+          uint16_t shown = emulator->shownGrey(px + m.geometry.offset_x,
+                                               py + m.geometry.offset_y, c);
+          if (shown != m.colour_lut[c][value[c]]) {
+            if (mismatches == 0) {
+              log_e("Emulated panel mismatch, mode %d pixel %d,%d: expected 0x%04x, got 0x%04x",
+                    mode, x, y, m.colour_lut[c][value[c]], shown);
+            }
+            mismatches++;
+          }
+        }
+      }
+    }
+  }
+
+  m.dma_bus.set_transfer_tap(nullptr, nullptr);
+  m.setMirror(savedMirrorX, savedMirrorY);
+  m.setRotation(savedRotation);
+  m.setPipelined(wasPipelined);
+
+  const MBI_Emulator::Stats& stats = emulator->getStats();
+  log_i("Emulated panel: config %s, GCLK payload %s, %d frames, %u pixel mismatches",
+        configOk ? "OK" : "WRONG", gclkOk ? "OK" : "WRONG", frames, mismatches);
+  log_i("Emulated panel: %u transfers, %u words, %u data latches, %u vsyncs, %u protocol errors, %lu us per emulated frame",
+        stats.transfers, stats.words, stats.data_latches, stats.v_syncs, stats.errors,
+        frameUs / frames);
+
+  delete emulator;
+}
+#endif
+
+#ifdef PANEL_UPCYCLED
+// The same stream of frames through update() in serial and pipelined mode.
+// Drawing every pixel of a changing pattern stands in for the render work.
+void Benchmark::framePipeline(UMatrix& m) {
+  const int frames = 60;
+  bool wasPipelined = m.isPipelined();
+
+  for (int pipelined = 0; pipelined < 2; pipelined++) {
+    m.setPipelined(pipelined);
+    if (m.isPipelined() != (bool)pipelined) {
+      continue;  // couldn't be started, already logged
+    }
+    m.takeFrameStats();
+
+    unsigned long start = micros();
+    for (int i = 0; i < frames; i++) {
+      for (uint16_t y = 0; y < m.geometry.res_y; y++) {
+        for (uint16_t x = 0; x < m.geometry.res_x; x++) {
+          m.mbi_store_pixel(x, y, patternValue(x + i, y, 0), patternValue(x + i, y, 1),
+                            patternValue(x + i, y, 2));
+        }
+      }
+      m.update();
+    }
+    unsigned long elapsedUs = micros() - start;
+    delay(50);  // let the encoder task catch up
+
+    UMatrix::FrameStats stats = m.takeFrameStats();
+    log_i("Frame pipeline %s: %.1f FPS rendered, %u presented, %u dropped, latency %llu us",
+          pipelined ? "on " : "off", frames * 1e6f / elapsedUs, stats.frames,
+          stats.dropped, stats.frames ? stats.latency_us / stats.frames : 0);
+  }
+
+  m.setPipelined(wasPipelined);
+}
+#endif
+
+#ifdef PANEL_UPCYCLED
+// Stacking foreground over background for the whole panel, once through a
+// std::function per pixel (what GFX_LayerCompositor::Stack() does), once
+// through the template sink with mbi_store_pixel() inlined, and once from the
+// compositor's layers as update() does it. Then the per pixel call that is
+// left: a GFX layer's display() into its compositor layer, against the same
+// pixels through the compositor's template sink.
+void Benchmark::pixelSink(UMatrix& m) {
+  const uint16_t w = m.geometry.res_x;
+  const uint16_t h = m.geometry.res_y;
+  const size_t pixels = (size_t)w * h;
+
+  CRGB* bg = (CRGB*)heap_caps_malloc(pixels * sizeof(CRGB), MALLOC_CAP_INTERNAL);
+  CRGB* fg = (CRGB*)heap_caps_malloc(pixels * sizeof(CRGB), MALLOC_CAP_INTERNAL);
+  CRGB* reference = (CRGB*)heap_caps_malloc((m.encoder.pixelCount() + 1) * sizeof(CRGB),
+                                            MALLOC_CAP_INTERNAL);
+  if (bg == nullptr || fg == nullptr || reference == nullptr) {
+    log_e("Pixel sink: not enough memory");
+    free(bg);
+    free(fg);
+    free(reference);
+    return;
+  }
+
+  // Foreground covers about half the panel, the rest shows the background
+  for (uint16_t y = 0; y < h; y++) {
+    for (uint16_t x = 0; x < w; x++) {
+      bg[y * w + x] = CRGB(patternValue(x, y, 0), patternValue(x, y, 1), patternValue(x, y, 2));
+      fg[y * w + x] = (patternValue(x, y, 3) & 1)
+                          ? CRGB(patternValue(y, x, 0), patternValue(y, x, 1), 0)
+                          : CRGB(0, 0, 0);
+    }
+  }
+
+  std::function<void(int16_t, int16_t, uint8_t, uint8_t, uint8_t)> perPixel =
+      [&m](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+        m.mbi_store_pixel(x, y, r, g, b);
+      };
+
+  m.clearScreen();
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    const CRGB* b = bg;
+    const CRGB* f = fg;
+    for (uint16_t y = 0; y < h; y++) {
+      for (uint16_t x = 0; x < w; x++, b++, f++) {
+        const CRGB& c = (f->r | f->g | f->b) ? *f : *b;
+        perPixel(x, y, c.r, c.g, c.b);
+      }
+    }
+  }
+  unsigned long functionUs = (micros() - start) / ITERATIONS;
+  memcpy(reference, m.framebuffer, (m.encoder.pixelCount() + 1) * sizeof(CRGB));
+
+  m.clearScreen();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.sink.stack(bg, fg, w, h);
+  }
+  unsigned long sinkUs = (micros() - start) / ITERATIONS;
+  bool identical =
+      memcmp(reference, m.framebuffer, m.encoder.pixelCount() * sizeof(CRGB)) == 0;
+
+  unsigned long compositeUs = 0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.clearScreen();
+    m.compositor.sink(LAYER_BACKGROUND).drawFrameRGB888((const uint8_t*)bg, w, h);
+    m.compositor.sink(LAYER_SCENE).drawFrameRGB888((const uint8_t*)fg, w, h);
+    start = micros();
+    m.compositor.composite(m.sink);
+    compositeUs += micros() - start;
+  }
+  compositeUs /= ITERATIONS;
+  bool compositeIdentical =
+      memcmp(reference, m.framebuffer, m.encoder.pixelCount() * sizeof(CRGB)) == 0;
+
+  m.clearScreen();
+  for (uint16_t y = 0; y < h; y++) {
+    for (uint16_t x = 0; x < w; x++) {
+      m.background->drawPixel(x, y, bg[y * w + x]);
+    }
+  }
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.background->display();
+  }
+  unsigned long displayUs = (micros() - start) / ITERATIONS;
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.compositor.sink(LAYER_BACKGROUND).drawFrameRGB888((const uint8_t*)bg, w, h);
+  }
+  unsigned long layerSinkUs = (micros() - start) / ITERATIONS;
+  m.background->clear();
+
+  m.clearScreen();
+  free(bg);
+  free(fg);
+  free(reference);
+
+  log_i("Pixel sink %ux%u stack: std::function %lu us, template sink %lu us per frame, output %s",
+        w, h, functionUs, sinkUs, identical ? "identical" : "DIFFERS");
+  log_i("Layer compositor %ux%u, 2 layers: %lu us per frame, output %s", w, h,
+        compositeUs, compositeIdentical ? "identical" : "DIFFERS");
+  log_i("GFX layer %ux%u: display() %lu us, template sink %lu us per frame", w, h,
+        displayUs, layerSinkUs);
+}
+#endif
+
+#ifndef PANEL_UPCYCLED
+// The old route, every pixel through a std::function into the library's
+// drawPixelRGB888(), against one pushFrame() of the same composited frame.
+void Benchmark::hub75Frame(OMatrix& m) {
+#ifdef DIRECT_FRAME
+  std::function<void(int16_t, int16_t, uint8_t, uint8_t, uint8_t)> perPixel =
+      [&m](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+        m.matrix->drawPixelRGB888(x, y, r, g, b);
+      };
+
+  for (uint16_t y = 0; y < PANEL_RES_Y; y++) {
+    for (uint16_t x = 0; x < PANEL_RES_X; x++) {
+      m.frame[y * PANEL_RES_X + x] = CRGB(patternValue(x, y, 0), patternValue(x, y, 1),
+                                          patternValue(x, y, 2));
+    }
+  }
+
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    for (uint16_t y = 0; y < PANEL_RES_Y; y++) {
+      for (uint16_t x = 0; x < PANEL_RES_X; x++) {
+        const CRGB& c = m.frame[y * PANEL_RES_X + x];
+        perPixel(x, y, c.r, c.g, c.b);
+      }
+    }
+  }
+  unsigned long perPixelUs = (micros() - start) / ITERATIONS;
+  uint32_t perPixelHash = m.matrix->backBufferHash();
+
+  m.matrix->clearScreen();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    m.matrix->pushFrame(m.frame, PANEL_RES_X, PANEL_RES_Y, m.rotation);
+  }
+  unsigned long pushFrameUs = (micros() - start) / ITERATIONS;
+  uint32_t pushFrameHash = m.matrix->backBufferHash();
+
+  m.clearScreen();
+
+  log_i("HUB75 frame: per-pixel %lu us, pushFrame %lu us per frame, output %s",
+        perPixelUs, pushFrameUs, perPixelHash == pushFrameHash ? "identical" : "DIFFERS");
+#else
+  log_i("HUB75 frame: DIRECT_FRAME disabled");
+#endif
+}
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+#include "GeneralSettings.h"
+#include "Matrix.h"
+
+#ifdef PANEL_UPCYCLED
+class UMatrix;
+#else
+class OMatrix;
+#endif
+
+// On-device benchmarks and self checks for the rendering pipeline.
+// Enabled with RUN_BENCHMARKS in GeneralSettings.h, results are logged once at boot.
+class Benchmark {
+ public:
+  static void run(Matrix* matrix);
+
+ private:
+  static constexpr int ITERATIONS = 20;
+
+  static void rasterizer(Matrix& matrix);
+  static void text(Matrix& matrix);
+  static void noise(Matrix& matrix);
+  static void fastNoise(Matrix& matrix);
+  static void life(Matrix& matrix);
+  static void lsystem(Matrix& matrix);
+
+#ifdef PANEL_UPCYCLED
+  static void frameEncoder(UMatrix& matrix);
+  static void emulatedOutput(UMatrix& matrix);
+  static void framePipeline(UMatrix& matrix);
+  static void pixelSink(UMatrix& matrix);
+#else
+  static void hub75Frame(OMatrix& matrix);
+#endif
+};
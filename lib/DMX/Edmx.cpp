@@ -29,18 +29,7 @@ void Edmx::update() {
     newPacket = false;
     stateManager->getState()->mode = prevMode;
   }
-  uint16_t k = 0;
-  for (uint16_t j = 0; j < matrix->getYResolution(); j++) {
-    for (uint16_t i = 0; i < matrix->getXResolution(); i++) {
-      if (isRGBMode) {
-        matrix->drawPixelRGB888(i, j, rawDataBuffer[k], rawDataBuffer[k + 1], rawDataBuffer[k + 2]);
-        k += 3;
-      } else {
-        matrix->drawPixelRGB888(i, j, rawDataBuffer[k], rawDataBuffer[k], rawDataBuffer[k]);
-        k++;
-      }
-    }
-  }
+  matrix->drawFrame(rawDataBuffer, isRGBMode);
 }
 
 void Edmx::setRGBMode(bool rgbMode) {
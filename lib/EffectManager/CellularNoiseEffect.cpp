@@ -15,9 +15,13 @@ void CellularNoiseEffect::setSpeed(float s) {
 
 void CellularNoiseEffect::update() {
   unsigned long currentTime = millis();
-    for(float i = 0; i < m_matrix->getXResolution(); i++) {
-        for(float j = 0; j < m_matrix->getYResolution(); j++) {
-            int noiseNow = int((1 + noise.GetNoise(j, i, float(currentTime) * speed)) * 127.5);
+    const int height = m_matrix->getYResolution();
+    column.resize(height);
+    for(int i = 0; i < m_matrix->getXResolution(); i++) {
+        // The noise's x runs down the panel
+        noise.GetNoiseRow(column.data(), height, 1, 0.0f, float(i), float(currentTime) * speed, 1.0f);
+        for(int j = 0; j < height; j++) {
+            int noiseNow = int((1 + column[j]) * 127.5);
             CRGB col = baseColor;
             int reducedNoise = noiseNow-50;
             if(reducedNoise > 0)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <ArduinoJson.h>
+
 #include "Matrix.h"
 
 class Effect {
@@ -21,6 +23,11 @@ public:
     void setSpeed(float speed) {
       this->speed = speed;
     }
+    // From the effect settings popup, keys the effect doesn't know are ignored
+    virtual void updateSettings(JsonObject settings) {}
+    // False for effects that only draw through m_matrix->raster(), so that
+    // the GFX background layer isn't displayed under them every frame
+    virtual bool usesBackgroundLayer() const { return true; }
 
 protected:
     Matrix* m_matrix;
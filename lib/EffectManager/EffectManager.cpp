@@ -21,6 +21,9 @@ EffectManager::~EffectManager() {
 void EffectManager::updateCurrentEffect() {
     if (m_currentEffect < m_effects.size()) {
         m_effects[m_currentEffect]->update();
+        if (m_effects[m_currentEffect]->usesBackgroundLayer()) {
+            m_matrix->background->display();
+        }
     }
 }
 
@@ -61,6 +64,12 @@ void EffectManager::setEffect(const std::string& name) {
   }
 }
 
+void EffectManager::updateEffectSettings(size_t number, JsonObject settings) {
+    if (number < m_effects.size()) {
+        m_effects[number]->updateSettings(settings);
+    }
+}
+
 size_t EffectManager::getEffectCount() const {
     return m_effects.size();
 }
@@ -23,6 +23,7 @@ public:
     void setEffect(const std::string& name);
     void nextEffect();
     void prevEffect();
+    void updateEffectSettings(size_t number, JsonObject settings);
     
     size_t getEffectCount() const;
     const char* getCurrentEffectName() const;
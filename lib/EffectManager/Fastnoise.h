@@ -51,6 +51,7 @@
 #define FASTNOISELITE_H
 
 #include <cmath>
+#include <cstdint>
 
 class FastNoiseLite
 {
@@ -298,18 +299,7 @@ public:
         Arguments_must_be_floating_point_values<FNfloat>();
 
         TransformNoiseCoordinate(x, y);
-
-        switch (mFractalType)
-        {
-        default:
-            return GenNoiseSingle(mSeed, x, y);
-        case FractalType_FBm:
-            return GenFractalFBm(x, y);
-        case FractalType_Ridged:
-            return GenFractalRidged(x, y);
-        case FractalType_PingPong:
-            return GenFractalPingPong(x, y);
-        }
+        return GenPoint(x, y);
     }
 
     /// <summary>
@@ -324,20 +314,89 @@ public:
         Arguments_must_be_floating_point_values<FNfloat>();
 
         TransformNoiseCoordinate(x, y, z);
+        return GenPoint(x, y, z);
+    }
 
-        switch (mFractalType)
+
+    /// <summary>
+    /// 2D noise at count points x + i * dx, y, written to out[i * stride]
+    /// </summary>
+    /// <remarks>
+    /// Same values as GetNoise() for each point, within float rounding. Value
+    /// and ValueCubic noise reduce each lattice column once for the whole row
+    /// when the row still runs along x after the transform, the points in
+    /// between only interpolate. Other noise types are sampled point by point
+    /// as GetNoise() does.
+    /// </remarks>
+    template <typename FNfloat, typename Out>
+    void GetNoiseRow(Out* out, int count, int stride, FNfloat x, FNfloat y, FNfloat dx) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        FNfloat sx = dx, sy = 0;
+        TransformNoiseCoordinate(x, y);
+        TransformNoiseCoordinate(sx, sy);
+        GenRow(out, count, stride, x, y, sx, sy);
+    }
+
+    /// <summary>
+    /// 3D noise at count points x + i * dx, y, z, written to out[i * stride]
+    /// </summary>
+    template <typename FNfloat, typename Out>
+    void GetNoiseRow(Out* out, int count, int stride, FNfloat x, FNfloat y, FNfloat z, FNfloat dx) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        FNfloat sx = dx, sy = 0, sz = 0;
+        TransformNoiseCoordinate(x, y, z);
+        TransformNoiseCoordinate(sx, sy, sz);
+        GenRow(out, count, stride, x, y, z, sx, sy, sz);
+    }
+
+    /// <summary>
+    /// 2D noise over a width x height lattice from x, y, sample i of row j
+    /// at x + i * dx, y + j * dy written to out[j * rowStride + i]
+    /// </summary>
+    /// <remarks>
+    /// Out is float, or int16_t for noise in Q15 fixed point (-32767...32767)
+    /// </remarks>
+    template <typename FNfloat, typename Out>
+    void GetNoiseGrid(Out* out, int width, int height, int rowStride,
+                      FNfloat x, FNfloat y, FNfloat dx, FNfloat dy) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        // The transforms are linear, the lattice's steps transform on their own
+        FNfloat sx = dx, sy = 0;
+        FNfloat rx = 0, ry = dy;
+        TransformNoiseCoordinate(x, y);
+        TransformNoiseCoordinate(sx, sy);
+        TransformNoiseCoordinate(rx, ry);
+        for (int j = 0; j < height; j++)
         {
-        default:
-            return GenNoiseSingle(mSeed, x, y, z);
-        case FractalType_FBm:
-            return GenFractalFBm(x, y, z);
-        case FractalType_Ridged:
-            return GenFractalRidged(x, y, z);
-        case FractalType_PingPong:
-            return GenFractalPingPong(x, y, z);
+            GenRow(out + j * rowStride, width, 1, x + j * rx, y + j * ry, sx, sy);
         }
     }
 
+    /// <summary>
+    /// 3D noise over a width x height lattice in the z plane, as the 2D GetNoiseGrid()
+    /// </summary>
+    template <typename FNfloat, typename Out>
+    void GetNoiseGrid(Out* out, int width, int height, int rowStride,
+                      FNfloat x, FNfloat y, FNfloat z, FNfloat dx, FNfloat dy) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        FNfloat sx = dx, sy = 0, sz = 0;
+        FNfloat rx = 0, ry = dy, rz = 0;
+        TransformNoiseCoordinate(x, y, z);
+        TransformNoiseCoordinate(sx, sy, sz);
+        TransformNoiseCoordinate(rx, ry, rz);
+        for (int j = 0; j < height; j++)
+        {
+            GenRow(out + j * rowStride, width, 1, x + j * rx, y + j * ry, z + j * rz, sx, sy, sz);
+        }
+    }
 
     /// <summary>
     /// 2D warps the input position using current domain warp settings
@@ -658,6 +717,287 @@ private:
     }
 
 
+    // Row noise gen, coordinates already transformed
+
+    static const int RowChunk = 32;
+
+    static void StoreNoise(float& out, float noise) { out = noise; }
+
+    static void StoreNoise(int16_t& out, float noise)
+    {
+        int q = FastRound(noise * 32767.0f);
+        out = (int16_t)(q > 32767 ? 32767 : q < -32767 ? -32767 : q);
+    }
+
+    // One point, as GetNoise() does after the transform
+    template <typename FNfloat>
+    float GenPoint(FNfloat x, FNfloat y) const
+    {
+        switch (mFractalType)
+        {
+        default:
+            return GenNoiseSingle(mSeed, x, y);
+        case FractalType_FBm:
+            return GenFractalFBm(x, y);
+        case FractalType_Ridged:
+            return GenFractalRidged(x, y);
+        case FractalType_PingPong:
+            return GenFractalPingPong(x, y);
+        }
+    }
+
+    template <typename FNfloat>
+    float GenPoint(FNfloat x, FNfloat y, FNfloat z) const
+    {
+        switch (mFractalType)
+        {
+        default:
+            return GenNoiseSingle(mSeed, x, y, z);
+        case FractalType_FBm:
+            return GenFractalFBm(x, y, z);
+        case FractalType_Ridged:
+            return GenFractalRidged(x, y, z);
+        case FractalType_PingPong:
+            return GenFractalPingPong(x, y, z);
+        }
+    }
+
+    // Value and ValueCubic noise are separable. Along a row in x, with y and z
+    // fixed, each lattice column can be reduced once with the row's y and z
+    // weights, and every point between two columns then only interpolates in x.
+    // The other noise types share nothing between points and go one at a time.
+    template <typename FNfloat>
+    bool IsRowSeparable(FNfloat sy, FNfloat sz) const
+    {
+        return (mNoiseType == NoiseType_Value || mNoiseType == NoiseType_ValueCubic) && sy == 0 && sz == 0;
+    }
+
+    // Taps lattice columns around each point, from FastFloor(x) - (Taps / 2 - 1).
+    // They are worked out again only when a point lands in another cell.
+    template <int Taps, typename FNfloat, typename Column, typename Interp>
+    static void LatticeSpan(FNfloat x, FNfloat sx, int count, float* noise, Column column, Interp interp)
+    {
+        float c[Taps];
+        int cell = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            FNfloat px = x + i * sx;
+            int xi = FastFloor(px);
+
+            if (i > 0 && xi == cell + 1)
+            {
+                for (int t = 0; t < Taps - 1; t++) c[t] = c[t + 1];
+                c[Taps - 1] = column(xi + Taps / 2);
+            }
+            else if (i == 0 || xi != cell)
+            {
+                for (int t = 0; t < Taps; t++) c[t] = column(xi + t - (Taps / 2 - 1));
+            }
+            cell = xi;
+            noise[i] = interp(c, (float)(px - xi));
+        }
+    }
+
+    template <typename FNfloat>
+    void GenNoiseSpan(int seed, FNfloat x, FNfloat y, FNfloat sx, int count, float* noise) const
+    {
+        if (mNoiseType == NoiseType_Value)
+        {
+            int y0 = FastFloor(y);
+            float ys = InterpHermite((float)(y - y0));
+            y0 *= PrimeY;
+            int y1 = y0 + PrimeY;
+
+            LatticeSpan<2>(x, sx, count, noise,
+                [&](int xi) {
+                    int xp = xi * PrimeX;
+                    return Lerp(ValCoord(seed, xp, y0), ValCoord(seed, xp, y1), ys);
+                },
+                [](const float* c, float t) { return Lerp(c[0], c[1], InterpHermite(t)); });
+            return;
+        }
+
+        int y1 = FastFloor(y);
+        float ys = (float)(y - y1);
+        y1 *= PrimeY;
+        int y0 = y1 - PrimeY;
+        int y2 = y1 + PrimeY;
+        int y3 = y1 + (int)((long)PrimeY << 1);
+
+        LatticeSpan<4>(x, sx, count, noise,
+            [&](int xi) {
+                int xp = xi * PrimeX;
+                return CubicLerp(ValCoord(seed, xp, y0), ValCoord(seed, xp, y1), ValCoord(seed, xp, y2), ValCoord(seed, xp, y3), ys);
+            },
+            [](const float* c, float t) { return CubicLerp(c[0], c[1], c[2], c[3], t) * (1 / (1.5f * 1.5f)); });
+    }
+
+    template <typename FNfloat>
+    void GenNoiseSpan(int seed, FNfloat x, FNfloat y, FNfloat z, FNfloat sx, int count, float* noise) const
+    {
+        if (mNoiseType == NoiseType_Value)
+        {
+            int y0 = FastFloor(y);
+            int z0 = FastFloor(z);
+            float ys = InterpHermite((float)(y - y0));
+            float zs = InterpHermite((float)(z - z0));
+            y0 *= PrimeY;
+            z0 *= PrimeZ;
+            int y1 = y0 + PrimeY;
+            int z1 = z0 + PrimeZ;
+
+            LatticeSpan<2>(x, sx, count, noise,
+                [&](int xi) {
+                    int xp = xi * PrimeX;
+                    float yf0 = Lerp(ValCoord(seed, xp, y0, z0), ValCoord(seed, xp, y1, z0), ys);
+                    float yf1 = Lerp(ValCoord(seed, xp, y0, z1), ValCoord(seed, xp, y1, z1), ys);
+                    return Lerp(yf0, yf1, zs);
+                },
+                [](const float* c, float t) { return Lerp(c[0], c[1], InterpHermite(t)); });
+            return;
+        }
+
+        int y1 = FastFloor(y);
+        int z1 = FastFloor(z);
+        float ys = (float)(y - y1);
+        float zs = (float)(z - z1);
+        y1 *= PrimeY;
+        z1 *= PrimeZ;
+        const int yp[4] = { y1 - PrimeY, y1, y1 + PrimeY, y1 + (int)((long)PrimeY << 1) };
+        const int zp[4] = { z1 - PrimeZ, z1, z1 + PrimeZ, z1 + (int)((long)PrimeZ << 1) };
+
+        LatticeSpan<4>(x, sx, count, noise,
+            [&](int xi) {
+                int xp = xi * PrimeX;
+                float zf[4];
+                for (int k = 0; k < 4; k++)
+                {
+                    zf[k] = CubicLerp(ValCoord(seed, xp, yp[0], zp[k]), ValCoord(seed, xp, yp[1], zp[k]),
+                                      ValCoord(seed, xp, yp[2], zp[k]), ValCoord(seed, xp, yp[3], zp[k]), ys);
+                }
+                return CubicLerp(zf[0], zf[1], zf[2], zf[3], zs);
+            },
+            [](const float* c, float t) { return CubicLerp(c[0], c[1], c[2], c[3], t) * (1 / (1.5f * 1.5f * 1.5f)); });
+    }
+
+    // One octave's noise added to the sums, as the GenFractal*() loops do.
+    // 2D FBm clamps the noise for the weighting, 3D doesn't.
+    void AddOctave(const float* noise, float* sum, float* amp, int count, bool clampFBm) const
+    {
+        switch (mFractalType)
+        {
+        case FractalType_FBm:
+            for (int i = 0; i < count; i++)
+            {
+                sum[i] += noise[i] * amp[i];
+                amp[i] *= Lerp(1.0f, (clampFBm ? FastMin(noise[i] + 1, 2) : noise[i] + 1) * 0.5f, mWeightedStrength);
+                amp[i] *= mGain;
+            }
+            break;
+        case FractalType_Ridged:
+            for (int i = 0; i < count; i++)
+            {
+                float n = FastAbs(noise[i]);
+                sum[i] += (n * -2 + 1) * amp[i];
+                amp[i] *= Lerp(1.0f, 1 - n, mWeightedStrength);
+                amp[i] *= mGain;
+            }
+            break;
+        case FractalType_PingPong:
+            for (int i = 0; i < count; i++)
+            {
+                float n = PingPong((noise[i] + 1) * mPingPongStrength);
+                sum[i] += (n - 0.5f) * 2 * amp[i];
+                amp[i] *= Lerp(1.0f, n, mWeightedStrength);
+                amp[i] *= mGain;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool IsNoiseFractal() const
+    {
+        return mFractalType == FractalType_FBm || mFractalType == FractalType_Ridged || mFractalType == FractalType_PingPong;
+    }
+
+    template <typename FNfloat, typename Out>
+    void GenRow(Out* out, int count, int stride, FNfloat x, FNfloat y, FNfloat sx, FNfloat sy) const
+    {
+        if (!IsRowSeparable(sy, (FNfloat)0))
+        {
+            for (int i = 0; i < count; i++) StoreNoise(out[i * stride], GenPoint(x + i * sx, y + i * sy));
+            return;
+        }
+
+        float noise[RowChunk], sum[RowChunk], amp[RowChunk];
+
+        for (int start = 0; start < count; start += RowChunk)
+        {
+            int n = count - start < RowChunk ? count - start : RowChunk;
+            FNfloat cx = x + start * sx, cy = y;
+
+            if (!IsNoiseFractal())
+            {
+                GenNoiseSpan(mSeed, cx, cy, sx, n, noise);
+                for (int i = 0; i < n; i++) StoreNoise(out[(start + i) * stride], noise[i]);
+                continue;
+            }
+
+            FNfloat ox = sx;
+            int seed = mSeed;
+            for (int i = 0; i < n; i++) { sum[i] = 0; amp[i] = mFractalBounding; }
+            for (int o = 0; o < mOctaves; o++)
+            {
+                GenNoiseSpan(seed++, cx, cy, ox, n, noise);
+                AddOctave(noise, sum, amp, n, true);
+                cx *= mLacunarity; cy *= mLacunarity;
+                ox *= mLacunarity;
+            }
+            for (int i = 0; i < n; i++) StoreNoise(out[(start + i) * stride], sum[i]);
+        }
+    }
+
+    template <typename FNfloat, typename Out>
+    void GenRow(Out* out, int count, int stride, FNfloat x, FNfloat y, FNfloat z, FNfloat sx, FNfloat sy, FNfloat sz) const
+    {
+        if (!IsRowSeparable(sy, sz))
+        {
+            for (int i = 0; i < count; i++) StoreNoise(out[i * stride], GenPoint(x + i * sx, y + i * sy, z + i * sz));
+            return;
+        }
+
+        float noise[RowChunk], sum[RowChunk], amp[RowChunk];
+
+        for (int start = 0; start < count; start += RowChunk)
+        {
+            int n = count - start < RowChunk ? count - start : RowChunk;
+            FNfloat cx = x + start * sx, cy = y, cz = z;
+
+            if (!IsNoiseFractal())
+            {
+                GenNoiseSpan(mSeed, cx, cy, cz, sx, n, noise);
+                for (int i = 0; i < n; i++) StoreNoise(out[(start + i) * stride], noise[i]);
+                continue;
+            }
+
+            FNfloat ox = sx;
+            int seed = mSeed;
+            for (int i = 0; i < n; i++) { sum[i] = 0; amp[i] = mFractalBounding; }
+            for (int o = 0; o < mOctaves; o++)
+            {
+                GenNoiseSpan(seed++, cx, cy, cz, ox, n, noise);
+                AddOctave(noise, sum, amp, n, false);
+                cx *= mLacunarity; cy *= mLacunarity; cz *= mLacunarity;
+                ox *= mLacunarity;
+            }
+            for (int i = 0; i < n; i++) StoreNoise(out[(start + i) * stride], sum[i]);
+        }
+    }
+
+
     // Noise Coordinate Transforms (frequency, and possible skew or rotation)
 
     template <typename FNfloat>
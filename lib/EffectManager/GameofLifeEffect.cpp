@@ -1,28 +1,48 @@
 #include "GameofLifeEffect.h"
 
 GameofLifeEffect::GameofLifeEffect(Matrix* m) : Effect(m) {
-    WORLD_WIDTH = m->getXResolution() / CELL_SIZE;
-    WORLD_HEIGHT = m->getYResolution() / CELL_SIZE;
-    world.resize(WORLD_WIDTH, std::vector<Cell>(WORLD_HEIGHT));
+    trail.resize(m->getXResolution() * m->getYResolution());
+    buildFade();
+    resizeWorld();
     reset();
 }
 
 void GameofLifeEffect::update() {
+    applySettings();
+
     uint32_t currentTime = millis();
     uint32_t elapsedTime = currentTime - lastUpdateTime;
     uint32_t adjustedInterval = baseUpdateInterval / speed;
 
     if (elapsedTime >= adjustedInterval) {
-        updateWorld();
-      lastUpdateTime = currentTime;
+        world.step(steps);
+        for (uint8_t& b : trail) {
+            b = fade[b];
+        }
+        pan(elapsedTime);
+        lastUpdateTime = currentTime;
     }
 
-    // Display current generation
-    for (int i = 0; i < WORLD_WIDTH; i++) {
-        for (int j = 0; j < WORLD_HEIGHT; j++) {
-          CRGB color = baseColor;
-          color.nscale8(world[i][j].brightness);
-          m_matrix->background->drawPixel(i * CELL_SIZE, j * CELL_SIZE, color);
+    // Display the viewport of the current generation
+    const int width = m_matrix->getXResolution();
+    const int height = m_matrix->getYResolution();
+    const int left = (int)viewX;
+    const int top = (int)viewY;
+    const uint8_t states = world.getRule().states;
+    for (int j = 0; j < height; j++) {
+        int y = top + j / zoom;
+        for (int i = 0; i < width; i++) {
+            int x = left + i / zoom;
+            uint8_t& brightness = trail[j * width + i];
+            if (world.alive(x, y)) {
+                brightness = 255;
+            } else if (states > 2) {
+                uint8_t dying = world.dying(x, y) * 255 / (states - 1);
+                brightness = max(brightness, dying);
+            }
+            CRGB color = baseColor;
+            color.nscale8(brightness);
+            m_matrix->background->drawPixel(i, j, color);
         }
     }
 }
@@ -33,60 +53,97 @@ const char* GameofLifeEffect::getName() const {
 
 void GameofLifeEffect::reset() {
     randomFillWorld();
-    generation = 0;
+    std::fill(trail.begin(), trail.end(), 0);
+    viewX = viewY = 0;
 }
 
-void GameofLifeEffect::randomFillWorld() {
-    for (int i = 0; i < WORLD_WIDTH; i++) {
-        for (int j = 0; j < WORLD_HEIGHT; j++) {
-            if (random(100) < density) {
-                world[i][j] = {true, true, static_cast<uint8_t>(random(64)), 200};
-            } else {
-                world[i][j] = {false, false, 0, 0};
-            }
+void GameofLifeEffect::updateSettings(JsonObject settings) {
+    portENTER_CRITICAL(&settingsLock);
+    Settings next = pending;
+    portEXIT_CRITICAL(&settingsLock);
+
+    if (!settings["rule"].isNull()) {
+        const char* text = settings["rule"] | "";
+        if (LifeWorld::parseRule(text, next.rule)) {
+            log_i("Game of Life rule: %s", text);
+        } else {
+            log_e("Game of Life: not a rule: %s", text);
         }
     }
+    if (!settings["steps"].isNull()) {
+        next.steps = constrain(settings["steps"] | 1, 1, MAX_STEPS);
+    }
+    if (!settings["zoom"].isNull()) {
+        next.zoom = constrain(settings["zoom"] | 1, 1, MAX_ZOOM);
+    }
+    next.panX = settings["panX"] | next.panX;
+    next.panY = settings["panY"] | next.panY;
+    if (!settings["world"].isNull()) {
+        next.worldScale = constrain(settings["world"] | 1, 1, MAX_WORLD_SCALE);
+    }
+
+    portENTER_CRITICAL(&settingsLock);
+    pending = next;
+    settingsDirty = true;  // picked up by the next update()
+    portEXIT_CRITICAL(&settingsLock);
+}
+
+void GameofLifeEffect::applySettings() {
+    if (!settingsDirty)
+        return;
+    portENTER_CRITICAL(&settingsLock);
+    Settings next = pending;
+    settingsDirty = false;
+    portEXIT_CRITICAL(&settingsLock);
+
+    const LifeWorld::Rule& rule = world.getRule();
+    if (next.rule.birth != rule.birth || next.rule.survive != rule.survive ||
+        next.rule.states != rule.states) {
+        world.setRule(next.rule);
+    }
+    if (next.steps != steps) {
+        steps = next.steps;
+        buildFade();
+    }
+    zoom = next.zoom;
+    panX = next.panX;
+    panY = next.panY;
+    if (next.worldScale != worldScale) {
+        worldScale = next.worldScale;
+        resizeWorld();
+        reset();
+    }
 }
 
-int GameofLifeEffect::neighbours(int x, int y) {
-    return (world[(x + 1) % WORLD_WIDTH][y].prev) +
-           (world[x][(y + 1) % WORLD_HEIGHT].prev) +
-           (world[(x + WORLD_WIDTH - 1) % WORLD_WIDTH][y].prev) +
-           (world[x][(y + WORLD_HEIGHT - 1) % WORLD_HEIGHT].prev) +
-           (world[(x + 1) % WORLD_WIDTH][(y + 1) % WORLD_HEIGHT].prev) +
-           (world[(x + WORLD_WIDTH - 1) % WORLD_WIDTH][(y + 1) % WORLD_HEIGHT].prev) +
-           (world[(x + WORLD_WIDTH - 1) % WORLD_WIDTH][(y + WORLD_HEIGHT - 1) % WORLD_HEIGHT].prev) +
-           (world[(x + 1) % WORLD_WIDTH][(y + WORLD_HEIGHT - 1) % WORLD_HEIGHT].prev);
+void GameofLifeEffect::resizeWorld() {
+    world.resize(m_matrix->getXResolution() * worldScale, m_matrix->getYResolution() * worldScale);
 }
 
-void GameofLifeEffect::updateWorld() {
-    // Birth and death cycle
-    for (int x = 0; x < WORLD_WIDTH; x++) {
-        for (int y = 0; y < WORLD_HEIGHT; y++) {
-            if (world[x][y].brightness > 0 && !world[x][y].prev)
-                world[x][y].brightness *= 0.9;
-            
-            int count = neighbours(x, y);
-            if (count == 3 && !world[x][y].prev) {
-                // A new cell is born
-                world[x][y].alive = true;
-                world[x][y].hue += 2;
-                world[x][y].brightness = 255;
-            } else if ((count < 2 || count > 3) && world[x][y].prev) {
-                // Cell dies
-                world[x][y].alive = false;
+void GameofLifeEffect::randomFillWorld() {
+    world.clear();
+    for (int y = 0; y < world.height(); y++) {
+        for (int x = 0; x < world.width(); x++) {
+            if (random(100) < density) {
+                world.set(x, y, true);
             }
         }
     }
+}
 
-    // Copy next generation into place
-    for (int x = 0; x < WORLD_WIDTH; x++) {
-        for (int y = 0; y < WORLD_HEIGHT; y++) {
-            world[x][y].prev = world[x][y].alive;
+// As a dead cell's brightness *= 0.9 once per generation
+void GameofLifeEffect::buildFade() {
+    for (int b = 0; b < 256; b++) {
+        uint8_t v = b;
+        for (uint8_t n = 0; n < steps; n++) {
+            v *= 0.9;
         }
+        fade[b] = v;
     }
+}
 
-    generation++;
-    if (generation >= 256)
-        generation = 0;
-}
\ No newline at end of file
+void GameofLifeEffect::pan(uint32_t elapsed) {
+    viewX = fmodf(viewX + panX * elapsed / 1000.0f, world.width());
+    viewY = fmodf(viewY + panY * elapsed / 1000.0f, world.height());
+    if (viewX < 0) viewX += world.width();
+    if (viewY < 0) viewY += world.height();
+}
@@ -1,30 +1,54 @@
 #pragma once
 
 #include "Effect.h"
+#include "LifeWorld.h"
+
+#include <vector>
 
 class GameofLifeEffect : public Effect {
 private:
-    static constexpr int CELL_SIZE = 1;
-    int WORLD_WIDTH;
-    int WORLD_HEIGHT;
+    static constexpr uint8_t MAX_STEPS = 16;
+    static constexpr uint8_t MAX_ZOOM = 8;
+    static constexpr uint8_t MAX_WORLD_SCALE = 4;
+
     float speed = 1;
 
-    struct Cell {
-        bool alive : 1;
-        bool prev : 1;
-        uint8_t hue : 6;
-        uint8_t brightness;
+    LifeWorld world;
+    uint8_t worldScale = 1;  // the world is this many panels wide and high, in cells
+    uint8_t zoom = 1;        // panel pixels per cell
+    uint8_t steps = 1;       // generations per update
+    float panX = 0;          // viewport drift, cells per second
+    float panY = 0;
+    float viewX = 0;         // top left cell of the viewport
+    float viewY = 0;
+
+    // Per panel pixel: dead cells fade out over a few generations
+    std::vector<uint8_t> trail;
+    uint8_t fade[256];  // a trail value after `steps` generations
+
+    // Settings arrive from the web server task on the other core, and are
+    // applied by the next update() so the world is never resized under it
+    struct Settings {
+        LifeWorld::Rule rule;
+        uint8_t worldScale = 1;
+        uint8_t zoom = 1;
+        uint8_t steps = 1;
+        float panX = 0;
+        float panY = 0;
     };
+    Settings pending;
+    volatile bool settingsDirty = false;
+    portMUX_TYPE settingsLock = portMUX_INITIALIZER_UNLOCKED;
 
-    std::vector<std::vector<Cell>> world;
     uint32_t lastUpdateTime = 0;
     uint16_t updateInterval = 100; // Update interval in milliseconds
-    int generation = 0;
     unsigned int density = 50;
 
+    void resizeWorld();
     void randomFillWorld();
-    int neighbours(int x, int y);
-    void updateWorld();
+    void buildFade();
+    void pan(uint32_t elapsed);
+    void applySettings();
 
 public:
     GameofLifeEffect(Matrix* m);
@@ -32,4 +56,8 @@ public:
     void update() override;
     const char* getName() const override;
     void reset() override;
-};
\ No newline at end of file
+
+    // rule: B/S notation, e.g. "B36/S23" or "B2/S/C3", steps, zoom, world
+    // (panels per side), panX, panY (cells per second)
+    void updateSettings(JsonObject settings) override;
+};
@@ -3,11 +3,21 @@
 #include <cmath>
 
 LSystemEffect::LSystemEffect(Matrix* m) : Effect(m) {
+  ops = new Op[MAX_OPS];
+  assert(ops != nullptr);
   reset();
 }
 
+LSystemEffect::~LSystemEffect() {
+  delete[] ops;
+}
+
 void LSystemEffect::update() {
-  m_matrix->background->clear();
+  uint8_t generations = pendingGenerations;
+  if (generations) {
+    pendingGenerations = 0;
+    setGenerations(generations);
+  }
 
   if (scale < 1.0f) {
     scale += growthRate;
@@ -28,34 +38,126 @@ const char* LSystemEffect::getName() const {
 }
 
 void LSystemEffect::reset() {
-  word = "X";
-  maxGeneration = 5;
-  currGeneration = 0;
-  growthPercent = 1;
   growthRate = 0.001;
   scale = 0.0f;
 
-  for (int i = 0; i < maxGeneration; i++) {
-    generate();
+  unsigned long start = micros();
+  uint8_t generations = maxGeneration;
+  while (!compile(generations) && generations > 1) {
+    generations--;
+  }
+  stats.compileUs = micros() - start;
+  stats.generations = generations;
+  stats.ops = opCount;
+  stats.arenaBytes = MAX_OPS * sizeof(Op);
+  if (generations < maxGeneration) {
+    log_i("L-system: %d generations don't fit %u ops, drawing %u", maxGeneration, MAX_OPS,
+          generations);
   }
 }
 
-void LSystemEffect::generate() {
-  if (currGeneration == maxGeneration) {
-    currGeneration = 0;
-    word = "X";
-  } else {
-    std::string next = "";
-    for (char c : word) {
-      next += applyRules(c);
-    }
-    word = next;
-    currGeneration++;
+void LSystemEffect::updateSettings(JsonObject settings) {
+  if (!settings["complexity"].isNull()) {
+    pendingGenerations = constrain(settings["complexity"] | 3, 1, 5) + 2;
+  }
+}
+
+void LSystemEffect::setGenerations(uint8_t generations) {
+  maxGeneration = constrain(generations, 1, MAX_DEPTH);
+  reset();
+}
+
+bool LSystemEffect::compile(uint8_t generations) {
+  opCount = 0;
+  overflow = false;
+  turn = minTurn = maxTurn = 0;
+  depth = maxDepth = 0;
+  segmentOpen = false;
+  stats.segments = stats.flowers = 0;
+
+  expand('X', generations);
+  return !overflow;
+}
+
+// What c becomes after generations rewrites, depth first, as ops
+void LSystemEffect::expand(char c, uint8_t generations) {
+  if (overflow)
+    return;
+
+  const std::string* rule = nullptr;
+  if (generations > 0) {
+    if (c == 'X')
+      rule = &chooseOne(xRules);
+    else if (c == 'F')
+      rule = &chooseOne(fRules);
+  }
+  if (rule == nullptr) {
+    emit(c);
+    return;
+  }
+  for (char r : *rule) {
+    expand(r, generations - 1);
+  }
+}
+
+void LSystemEffect::emit(char c) {
+  switch (c) {
+    case 'F':
+      if (segmentOpen && ops[opCount - 1].count < 63) {
+        ops[opCount - 1].count++;
+      } else {
+        push(OP_SEGMENT, 1);
+        segmentOpen = !overflow;
+        minTurn = std::min(minTurn, turn);
+        maxTurn = std::max(maxTurn, turn);
+        stats.segments++;
+      }
+      break;
+    case '+':
+    case '-':
+      turn += c == '+' ? -1 : 1;
+      segmentOpen = false;
+      if (turn < -MAX_TURN || turn > MAX_TURN)
+        overflow = true;
+      break;
+    case '[':
+      if (depth == MAX_DEPTH) {
+        overflow = true;
+        break;
+      }
+      push(OP_PUSH, 0);
+      turnStack[depth++] = turn;
+      maxDepth = std::max(maxDepth, depth);
+      break;
+    case ']':
+      // As an unmatched ] always did, nothing
+      if (depth) {
+        push(OP_POP, 0);
+        turn = turnStack[--depth];
+      }
+      break;
+    case 'A':
+    case 'B':
+      push(OP_FLOWER, c - 'A');
+      stats.flowers++;
+      break;
+  }
+}
+
+void LSystemEffect::push(OpKind kind, uint8_t count) {
+  segmentOpen = false;
+  if (opCount == MAX_OPS) {
+    overflow = true;
+    return;
   }
-  growthPercent = 0;
+  Op& op = ops[opCount++];
+  op.kind = kind;
+  op.count = count;
+  op.turn = turn;
 }
 
-std::string LSystemEffect::chooseOne(const std::vector<Rule>& ruleSet) {
+const std::string& LSystemEffect::chooseOne(const std::vector<Rule>& ruleSet) {
+  static const std::string none;
   float n = static_cast<float>(random(100)) / 100.0f;
   float t = 0;
   for (const auto& rule : ruleSet) {
@@ -64,64 +166,70 @@ std::string LSystemEffect::chooseOne(const std::vector<Rule>& ruleSet) {
       return rule.rule;
     }
   }
-  return "";
-}
-
-std::string LSystemEffect::applyRules(char c) {
-  switch (c) {
-    case 'X':
-      return chooseOne(xRules);
-    case 'F':
-      return chooseOne(fRules);
-    default:
-      return std::string(1, c);
-  }
+  return none;
 }
 
 void LSystemEffect::drawLSystem() {
+  Rasterizer raster = m_matrix->raster(LAYER_BACKGROUND);
   int x = m_matrix->getXResolution() / 2;
   int y = m_matrix->getYResolution() - 1;
-  float angle = -M_PI / 2;  // Start growing upwards
-  std::vector<std::tuple<int, int, float>> stack;
 
   const float subPixelScale = 4.0f;
   float subX = x * subPixelScale;
   float subY = y * subPixelScale;
 
-  for (char c : word) {
-    switch (c) {
-      case 'F': {
-        float newSubX = subX + cos(angle) * len * subPixelScale * scale;
-        float newSubY = subY + sin(angle) * len * subPixelScale * scale;
-        m_matrix->background->drawLine(subX / subPixelScale, subY / subPixelScale, 
-                                       newSubX / subPixelScale, newSubY / subPixelScale, 
-                                       CRGB(158, 169, 63));
+  // One F step for each heading the segments use, at this growth
+  float stepX[2 * MAX_TURN + 1];
+  float stepY[2 * MAX_TURN + 1];
+  for (int k = minTurn; k <= maxTurn; k++) {
+    float angle = -M_PI / 2 + k * (M_PI / 4 * scale);  // Upwards, + turning left
+    stepX[k + MAX_TURN] = cos(angle) * len * subPixelScale * scale;
+    stepY[k + MAX_TURN] = sin(angle) * len * subPixelScale * scale;
+  }
+
+  // Branch points are kept in whole sub-pixels, as they always were
+  int stackX[MAX_DEPTH];
+  int stackY[MAX_DEPTH];
+  uint8_t sp = 0;
+
+  const CRGB stem(158, 169, 63);
+  const CRGB flowers[2] = {CRGB(229, 206, 220), CRGB(252, 161, 125)};
+
+  for (uint16_t i = 0; i < opCount; i++) {
+    const Op& op = ops[i];
+    switch (op.kind) {
+      case OP_SEGMENT: {
+        // Stepped F by F rather than multiplied, so that the branch points,
+        // truncated below, land where they always did
+        float newSubX = subX;
+        float newSubY = subY;
+        for (uint8_t n = 0; n < op.count; n++) {
+          newSubX += stepX[op.turn + MAX_TURN];
+          newSubY += stepY[op.turn + MAX_TURN];
+        }
+        raster.drawLine(toFixed(subX / subPixelScale), toFixed(subY / subPixelScale),
+                        toFixed(newSubX / subPixelScale), toFixed(newSubY / subPixelScale), stem);
         subX = newSubX;
         subY = newSubY;
       } break;
-      case '+':
-        angle -= M_PI / 4 * scale;
+      case OP_PUSH:
+        if (sp == MAX_DEPTH)
+          break;
+        stackX[sp] = subX;
+        stackY[sp] = subY;
+        sp++;
         break;
-      case '-':
-        angle += M_PI / 4 * scale;
+      case OP_POP:
+        if (sp == 0)
+          break;
+        sp--;
+        subX = stackX[sp];
+        subY = stackY[sp];
         break;
-      case '[':
-        stack.push_back({subX, subY, angle});
-        break;
-      case ']':
-        if (!stack.empty()) {
-          std::tie(subX, subY, angle) = stack.back();
-          stack.pop_back();
-        }
-        break;
-      case 'A':
-        m_matrix->background->fillCircle(subX / subPixelScale, subY / subPixelScale, 
-                                         len * scale, CRGB(229, 206, 220));
-        break;
-      case 'B':
-        m_matrix->background->fillCircle(subX / subPixelScale, subY / subPixelScale, 
-                                         len * scale, CRGB(252, 161, 125));
+      case OP_FLOWER:
+        raster.fillCircle(toFixed(subX / subPixelScale), toFixed(subY / subPixelScale),
+                          toFixed(len * scale), flowers[op.count]);
         break;
     }
   }
-}
\ No newline at end of file
+}
@@ -5,12 +5,37 @@
 #include <vector>
 #include <string>
 
+// The word is never built: reset() expands the axiom depth first straight into
+// a flat list of drawing ops (runs of F as one segment, brackets, flowers) in
+// an arena allocated once. A segment keeps its heading as a count of turns,
+// so a frame only needs the growth scale's sin/cos for each count in use and
+// then walks the list.
 class LSystemEffect : public Effect {
 public:
+    // What reset() compiled
+    struct Stats {
+        uint8_t generations;  // less than asked for if the ops didn't fit
+        uint32_t ops;
+        uint32_t segments;
+        uint32_t flowers;
+        uint32_t arenaBytes;
+        uint32_t compileUs;
+    };
+
     LSystemEffect(Matrix* m);
+    ~LSystemEffect();
     void update() override;
     const char* getName() const override;
     void reset();
+    // Drawn with the rasterizer straight into the background compositor layer
+    bool usesBackgroundLayer() const override { return false; }
+
+    // complexity 1-5: 3 to 7 generations, recompiled by the next update()
+    void updateSettings(JsonObject settings) override;
+    // Recompiles now, from the display task only
+    void setGenerations(uint8_t generations);
+    void setGrowth(float growth) { scale = growth; }
+    const Stats& getStats() const { return stats; }
 
 private:
     struct Rule {
@@ -18,6 +43,18 @@ private:
         float prob;
     };
 
+    enum OpKind : uint8_t { OP_SEGMENT, OP_PUSH, OP_POP, OP_FLOWER };
+
+    struct Op {
+        uint8_t kind : 2;
+        uint8_t count : 6;  // F steps of a segment, colour of a flower
+        int8_t turn;        // heading of a segment, in turns from straight up
+    };
+
+    static constexpr uint16_t MAX_OPS = 16384;  // 32 kB, about 8 generations
+    static constexpr uint8_t MAX_DEPTH = 32;    // bracket nesting, one per generation
+    static constexpr int8_t MAX_TURN = 32;
+
     const float len = 1.0f;
 
     std::vector<Rule> xRules = {
@@ -36,19 +73,35 @@ private:
         {"F", 0.1}
     };
 
-    std::string word;
-    int maxGeneration;
-    int currGeneration;
-    float growthPercent;
+    int maxGeneration = 5;
+    // From the web server task on the other core, 0 for none. update() picks
+    // it up so that the ops are never rewritten while they are being drawn.
+    volatile uint8_t pendingGenerations = 0;
     float growthRate;
     float scale;
     int fullGrowthDelay;
     static const int FULL_GROWTH_DELAY_MAX = 600; // Adjust as needed
 
-    void generate();
+    Op* ops = nullptr;  // MAX_OPS of them
+    uint16_t opCount = 0;
+    bool overflow = false;
+    Stats stats = {};
+
+    // Compile time state
+    int8_t turn = 0;
+    int8_t minTurn = 0;
+    int8_t maxTurn = 0;
+    uint8_t depth = 0;
+    uint8_t maxDepth = 0;
+    int8_t turnStack[MAX_DEPTH];  // heading at each open [
+    bool segmentOpen = false;  // the last op is a segment more F can join
+
+    bool compile(uint8_t generations);
+    void expand(char c, uint8_t generations);
+    void emit(char c);
+    void push(OpKind kind, uint8_t count);
     void drawLSystem();
-    std::string chooseOne(const std::vector<Rule>& rules);
-    std::string applyRules(char c);
+    const std::string& chooseOne(const std::vector<Rule>& rules);
 };
 
-#endif // LSYSTEM_EFFECT_H
\ No newline at end of file
+#endif // LSYSTEM_EFFECT_H
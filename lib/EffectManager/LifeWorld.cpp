@@ -0,0 +1,246 @@
+#include "LifeWorld.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if __has_include(<Arduino.h>)
+#include <Arduino.h>
+#else
+#define log_d(...)
+#endif
+
+static bool parseDigits(const char* text, size_t length, uint16_t& mask) {
+    uint16_t m = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '8')
+            return false;
+        m |= 1 << (text[i] - '0');
+    }
+    mask = m;
+    return true;
+}
+
+static bool parseNumber(const char* text, size_t length, uint8_t& value) {
+    if (length == 0 || length > 2)
+        return false;
+    uint8_t v = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9')
+            return false;
+        v = v * 10 + (text[i] - '0');
+    }
+    value = v;
+    return true;
+}
+
+bool LifeWorld::parseRule(const char* text, Rule& rule) {
+    Rule parsed;
+    parsed.birth = parsed.survive = 0;
+    bool lettered = strpbrk(text, "BbSs") != nullptr;
+    bool has_birth = false;
+    bool has_survive = false;
+
+    uint8_t field = 0;
+    for (const char* part = text;; field++) {
+        size_t length = strcspn(part, "/");
+        char letter = toupper(*part);
+        bool ok;
+        if (lettered) {
+            if (letter == 'B') {
+                ok = !has_birth && parseDigits(part + 1, length - 1, parsed.birth);
+                has_birth = true;
+            } else if (letter == 'S') {
+                ok = !has_survive && parseDigits(part + 1, length - 1, parsed.survive);
+                has_survive = true;
+            } else if (letter == 'C' || letter == 'G') {
+                ok = parseNumber(part + 1, length - 1, parsed.states);
+            } else {
+                ok = field == 2 && parseNumber(part, length, parsed.states);
+            }
+        } else {
+            // Golly's survival first order
+            if (field == 0) {
+                ok = parseDigits(part, length, parsed.survive);
+            } else if (field == 1) {
+                ok = parseDigits(part, length, parsed.birth);
+                has_birth = true;
+            } else {
+                ok = field == 2 && parseNumber(part, length, parsed.states);
+            }
+            has_survive = true;
+        }
+        if (!ok)
+            return false;
+
+        part += length;
+        if (*part != '/')
+            break;
+        part++;
+    }
+
+    if (!has_birth || !has_survive || parsed.states < 2 || parsed.states > MAX_STATES)
+        return false;
+    rule = parsed;
+    return true;
+}
+
+void LifeWorld::resize(uint16_t width, uint16_t height) {
+    w = width;
+    h = height;
+    words = (w + 63) / 64;
+    last_mask = (w & 63) ? (1ULL << (w & 63)) - 1 : ~0ULL;
+    cells.assign((size_t)words * h, 0);
+    next.assign(cells.size(), 0);
+    setRule(rule);
+    log_d("Life world %ux%u, %u words per row", w, h, words);
+}
+
+void LifeWorld::setRule(const Rule& r) {
+    rule = r;
+    dying_planes = 0;
+    while ((1 << dying_planes) <= rule.states - 2) {
+        dying_planes++;
+    }
+    // Cells dying under the old rule are let go
+    dying_counts.assign((size_t)dying_planes * cells.size(), 0);
+}
+
+void LifeWorld::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+    std::fill(dying_counts.begin(), dying_counts.end(), 0);
+    generations = 0;
+}
+
+void LifeWorld::set(int x, int y, bool alive) {
+    uint32_t i = index(x, y);
+    uint64_t bit = 1ULL << (i & 63);
+    if (alive) {
+        cells[i >> 6] |= bit;
+    } else {
+        cells[i >> 6] &= ~bit;
+    }
+    for (uint8_t p = 0; p < dying_planes; p++) {
+        dying_counts[p * cells.size() + (i >> 6)] &= ~bit;
+    }
+}
+
+uint8_t LifeWorld::dying(int x, int y) const {
+    uint32_t i = index(x, y);
+    uint8_t count = 0;
+    for (uint8_t p = 0; p < dying_planes; p++) {
+        count |= ((dying_counts[p * cells.size() + (i >> 6)] >> (i & 63)) & 1) << p;
+    }
+    return count;
+}
+
+uint32_t LifeWorld::population() const {
+    uint32_t count = 0;
+    for (uint64_t word : cells) {
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+void LifeWorld::step(uint16_t generations) {
+    if (cells.empty())
+        return;
+    for (uint16_t n = 0; n < generations; n++) {
+        stepOnce();
+    }
+}
+
+static inline void fullAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) {
+    uint64_t t = a ^ b;
+    sum = t ^ c;
+    carry = (a & b) | (t & c);
+}
+
+// Cells whose neighbour count, in bit planes, is one of those in mask
+static inline uint64_t countIn(uint16_t mask, uint64_t ones, uint64_t twos, uint64_t fours,
+                               uint64_t eights) {
+    uint64_t match = 0;
+    for (; mask; mask &= mask - 1) {
+        uint8_t n = __builtin_ctz(mask);
+        match |= (n & 1 ? ones : ~ones) & (n & 2 ? twos : ~twos) & (n & 4 ? fours : ~fours) &
+                 (n & 8 ? eights : ~eights);
+    }
+    return match;
+}
+
+void LifeWorld::stepOnce() {
+    const uint8_t last_bit = (w - 1) & 63;
+    const size_t plane = cells.size();
+    const bool conway = rule.birth == (1 << 3) && rule.survive == ((1 << 2) | (1 << 3)) &&
+                        rule.states == 2;
+    const uint8_t dying_start = rule.states - 2;
+
+    for (uint16_t y = 0; y < h; y++) {
+        const uint64_t* rows[3] = {&cells[(size_t)(y ? y - 1 : h - 1) * words],
+                                   &cells[(size_t)y * words],
+                                   &cells[(size_t)(y + 1 < h ? y + 1 : 0) * words]};
+        uint64_t* out = &next[(size_t)y * words];
+
+        for (uint16_t i = 0; i < words; i++) {
+            // Each row as it is and shifted so bit x holds cell x - 1 (west)
+            // and x + 1 (east)
+            uint64_t c[3], west[3], east[3];
+            for (uint8_t r = 0; r < 3; r++) {
+                const uint64_t* row = rows[r];
+                c[r] = row[i];
+                uint64_t west_in = i ? row[i - 1] >> 63 : (row[words - 1] >> last_bit) & 1;
+                uint64_t east_in = i + 1 < words ? row[i + 1] << 63 : (row[0] & 1) << last_bit;
+                west[r] = (c[r] << 1) | west_in;
+                east[r] = (c[r] >> 1) | east_in;
+            }
+
+            // Eight one-bit neighbours summed into ones, twos, fours, eights
+            uint64_t s0, c0, s1, c1, ones, c3, t, c4;
+            fullAdd(west[0], c[0], east[0], s0, c0);
+            fullAdd(west[1], east[1], west[2], s1, c1);
+            uint64_t s2 = c[2] ^ east[2];
+            uint64_t c2 = c[2] & east[2];
+            fullAdd(s0, s1, s2, ones, c3);
+            fullAdd(c0, c1, c2, t, c4);
+            uint64_t twos = t ^ c3;
+            uint64_t c5 = t & c3;
+            uint64_t fours = c4 ^ c5;
+            uint64_t eights = c4 & c5;
+
+            const uint64_t self = c[1];
+            const uint64_t mask = i + 1 < words ? ~0ULL : last_mask;
+            uint64_t alive;
+            if (conway) {
+                // Two or three, and three or alive
+                alive = twos & ~fours & ~eights & (ones | self);
+            } else if (!dying_planes) {
+                alive = (countIn(rule.birth, ones, twos, fours, eights) & ~self) |
+                        (countIn(rule.survive, ones, twos, fours, eights) & self);
+            } else {
+                const size_t at = (size_t)y * words + i;
+                uint64_t counting = 0;
+                for (uint8_t p = 0; p < dying_planes; p++) {
+                    counting |= dying_counts[p * plane + at];
+                }
+                uint64_t born = countIn(rule.birth, ones, twos, fours, eights) & ~self & ~counting;
+                uint64_t kept = countIn(rule.survive, ones, twos, fours, eights) & self;
+                uint64_t died = self & ~kept;
+                alive = born | kept;
+
+                // Count down the dying, start the ones that just died
+                uint64_t borrow = counting;
+                for (uint8_t p = 0; p < dying_planes; p++) {
+                    uint64_t& d = dying_counts[p * plane + at];
+                    uint64_t counted = d ^ borrow;
+                    borrow &= ~d;
+                    d = ((counted & ~died) | ((dying_start >> p) & 1 ? died : 0)) & mask;
+                }
+            }
+            out[i] = alive & mask;
+        }
+    }
+
+    cells.swap(next);
+    generations++;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Life-like cellular automata on a torus, 64 cells to a word. A generation
+// works a word at a time: the eight neighbours of 64 cells are the rows above,
+// alongside and below shifted by one cell, carrying in the edge cell of the
+// word next to it (or from the other side of the world), and their count is
+// summed bit-parallel in four bit planes with full adders.
+//
+// Rules are outer totalistic in B/S notation ("B3/S23" is Conway's), with an
+// optional C for the Generations family: a cell that doesn't survive then
+// takes C - 2 generations to die, can't be born into meanwhile and doesn't
+// count as a neighbour ("B2/S/C3" is Brian's Brain).
+class LifeWorld {
+public:
+    struct Rule {
+        uint16_t birth = 1 << 3;  // bit n: born with n neighbours
+        uint16_t survive = (1 << 2) | (1 << 3);
+        uint8_t states = 2;  // 2 for plain Life, up to MAX_STATES
+    };
+
+    static constexpr uint8_t MAX_STATES = 16;
+
+    // "B36/S23", "b2/s/c3", "B2/S345/4" and Golly's "23/3" (S/B). False, and
+    // rule left alone, if text isn't one.
+    static bool parseRule(const char* text, Rule& rule);
+
+    // All cells dead
+    void resize(uint16_t width, uint16_t height);
+    void setRule(const Rule& rule);
+    const Rule& getRule() const { return rule; }
+
+    void clear();
+    void set(int x, int y, bool alive);
+
+    // Coordinates wrap
+    bool alive(int x, int y) const {
+        uint32_t i = index(x, y);
+        return (cells[i >> 6] >> (i & 63)) & 1;
+    }
+    // Generations left before a dying cell is gone, 0 for a live or empty one
+    uint8_t dying(int x, int y) const;
+
+    void step(uint16_t generations = 1);
+
+    uint16_t width() const { return w; }
+    uint16_t height() const { return h; }
+    uint32_t generation() const { return generations; }
+    uint32_t population() const;
+
+private:
+    static constexpr uint8_t MAX_DYING_PLANES = 4;  // counts up to MAX_STATES - 2
+
+    uint32_t index(int x, int y) const {
+        x %= w;
+        y %= h;
+        if (x < 0) x += w;
+        if (y < 0) y += h;
+        return (uint32_t)y * words * 64 + x;
+    }
+
+    void stepOnce();
+
+    uint16_t w = 0;
+    uint16_t h = 0;
+    uint16_t words = 0;       // per row
+    uint64_t last_mask = 0;   // cells of a row's last word that are in the world
+    Rule rule;
+    uint8_t dying_planes = 0;
+    uint32_t generations = 0;
+
+    std::vector<uint64_t> cells;  // live cells, row after row
+    std::vector<uint64_t> next;
+    // Binary count of the generations a dying cell has left, bit plane by bit
+    // plane, each laid out as cells
+    std::vector<uint64_t> dying_counts;
+};
@@ -18,13 +18,14 @@ void NoiseEffect::reset() {}
 
 void NoiseEffect::update() {
     uint16_t currentTimeSpeedInt = millis() * speed;
-    for(int i = 0; i < m_matrix->getXResolution(); i++) {
-        int ioffset = scale * i;
-        for(int j = 0; j < m_matrix->getYResolution(); j++) {
-            int joffset = scale * j;
-            uint8_t noiseNow = inoise8(x + ioffset, y + joffset, currentTimeSpeedInt);
+    const int width = m_matrix->getXResolution();
+    row.resize(width);
+    for(int j = 0; j < m_matrix->getYResolution(); j++) {
+        int joffset = scale * j;
+        inoise8Row(row.data(), width, x, scale, y + joffset, currentTimeSpeedInt);
+        for(int i = 0; i < width; i++) {
             CRGB col = baseColor;
-            col.nscale8(noiseNow/2);
+            col.nscale8(row[i]/2);
             m_matrix->background->drawPixel(i, j, col);
         }
     }
@@ -2,12 +2,15 @@
 
 #include "Effect.h"
 
+#include <vector>
+
 class NoiseEffect : public Effect {
 private:
     uint16_t x = 0;
     uint16_t y = 0;
     uint8_t scale = 15;
     float speed = 0.05;
+    std::vector<uint8_t> row;  // one row of noise at a time
 
 public:
     NoiseEffect(Matrix* m);
@@ -3,6 +3,8 @@
 #include "Effect.h"
 #include "FastNoise.h"
 
+#include <vector>
+
 class SimplexNoiseEffect : public Effect {
 private:
   uint16_t x = 0;
@@ -10,6 +12,7 @@ private:
   uint8_t scale = 3;
   float speed = 0.01;
   FastNoiseLite noise;
+  std::vector<float> column;  // one column of noise at a time
 
 public:
   SimplexNoiseEffect(Matrix* m);
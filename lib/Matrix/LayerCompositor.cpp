@@ -0,0 +1,125 @@
+#include "LayerCompositor.hpp"
+
+LayerCompositor::~LayerCompositor() {
+  for (Layer& layer : layers) {
+    free(layer.pixels);
+    free(layer.coverage);
+  }
+}
+
+void LayerCompositor::begin(uint16_t w, uint16_t h) {
+  assert(w <= 32 << TILE_SHIFT && h <= MAX_TILE_ROWS << TILE_SHIFT);
+  width = w;
+  height = h;
+  tile_rows = (h + (1 << TILE_SHIFT) - 1) >> TILE_SHIFT;
+  uint8_t tile_cols = (w + (1 << TILE_SHIFT) - 1) >> TILE_SHIFT;
+  all_tiles = tile_cols >= 32 ? 0xFFFFFFFF : (1UL << tile_cols) - 1;
+}
+
+// Internal RAM if there is room, the planes are read once per frame in order
+// so PSRAM does fine otherwise
+bool LayerCompositor::allocate(Layer& layer) {
+  if (layer.alloc_failed)
+    return false;
+
+  size_t pixels = (size_t)width * height;
+  layer.pixels = (CRGB*)heap_caps_calloc(pixels, sizeof(CRGB), MALLOC_CAP_INTERNAL);
+  if (layer.pixels == nullptr) {
+    layer.pixels = (CRGB*)heap_caps_calloc(pixels, sizeof(CRGB), MALLOC_CAP_SPIRAM);
+  }
+  if (layer.pixels == nullptr) {
+    log_e("No memory for compositor layer %d", (int)(&layer - layers));
+    layer.alloc_failed = true;
+    return false;
+  }
+
+  log_d("Compositor layer %d: %u bytes", (int)(&layer - layers),
+        (unsigned)(pixels * sizeof(CRGB)));
+  return true;
+}
+
+// What was drawn before counts as covered
+bool LayerCompositor::allocateCoverage(Layer& layer) {
+  if (layer.alloc_failed)
+    return false;
+
+  size_t pixels = (size_t)width * height;
+  layer.coverage = (uint8_t*)heap_caps_malloc(pixels, MALLOC_CAP_INTERNAL);
+  if (layer.coverage == nullptr) {
+    layer.coverage = (uint8_t*)heap_caps_malloc(pixels, MALLOC_CAP_SPIRAM);
+  }
+  if (layer.coverage == nullptr) {
+    log_e("No memory for compositor layer %d coverage", (int)(&layer - layers));
+    layer.alloc_failed = true;
+    return false;
+  }
+
+  for (size_t i = 0; i < pixels; i++) {
+    const CRGB& p = layer.pixels[i];
+    layer.coverage[i] = (p.r | p.g | p.b) ? 255 : 0;
+  }
+  return true;
+}
+
+// Only the tiles drawn in are wiped, a run of them at a time
+void LayerCompositor::clear(LayerId id) {
+  Layer& layer = layers[id];
+  uint32_t cleared = 0;
+
+  for (uint8_t ty = 0; ty < tile_rows; ty++) {
+    uint32_t mask = layer.tiles[ty];
+    if (!mask)
+      continue;
+    layer.tiles[ty] = 0;
+
+    int16_t y_end = min((int16_t)height, (int16_t)((ty + 1) << TILE_SHIFT));
+    while (mask) {
+      uint8_t first = __builtin_ctz(mask);
+      uint32_t rest = mask >> first;
+      uint8_t run = ~rest ? __builtin_ctz(~rest) : 32 - first;  // adjacent tiles
+      mask &= run >= 32 ? 0 : ~(((1UL << run) - 1) << first);
+
+      int16_t x0 = first << TILE_SHIFT;
+      int16_t x1 = min((int16_t)width, (int16_t)((first + run) << TILE_SHIFT));
+      for (int16_t y = ty << TILE_SHIFT; y < y_end; y++) {
+        memset(&layer.pixels[y * width + x0], 0, (x1 - x0) * sizeof(CRGB));
+        if (layer.coverage != nullptr)
+          memset(&layer.coverage[y * width + x0], 0, x1 - x0);
+      }
+      cleared += (x1 - x0) * (y_end - (ty << TILE_SHIFT));
+    }
+  }
+
+  stats.cleared += cleared;
+}
+
+void LayerCompositor::clearAll() {
+  for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+    clear((LayerId)i);
+  }
+}
+
+LayerRect LayerCompositor::getDirty(LayerId id) const {
+  const Layer& layer = layers[id];
+  LayerRect rect;
+
+  for (uint8_t ty = 0; ty < tile_rows; ty++) {
+    uint32_t mask = layer.tiles[ty];
+    if (!mask)
+      continue;
+    int16_t x0 = __builtin_ctz(mask) << TILE_SHIFT;
+    int16_t x1 = ((32 - __builtin_clz(mask)) << TILE_SHIFT) - 1;
+    int16_t y0 = ty << TILE_SHIFT;
+    rect.add(x0, y0);
+    rect.add(min(x1, (int16_t)(width - 1)),
+             min((int16_t)(y0 + (1 << TILE_SHIFT) - 1), (int16_t)(height - 1)));
+  }
+
+  return rect;
+}
+
+LayerCompositor::Stats LayerCompositor::takeStats() {
+  Stats taken = stats;
+  stats = Stats();
+  return taken;
+}
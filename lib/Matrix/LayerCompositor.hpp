@@ -0,0 +1,301 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "GFX_Layer.hpp"
+#include "PixelSink.hpp"
+
+// Compositor layers, bottom to top
+enum LayerId : uint8_t {
+  LAYER_BACKGROUND = 0,  // what the mode shows: effect, image, text, DMX, water
+  LAYER_SCENE,           // aquarium fish, plants and food
+  LAYER_OVERLAY,         // touch menu
+  LAYER_SENSOR,          // sensor read-outs and demo text
+  LAYER_COUNT
+};
+
+enum class BlendMode : uint8_t {
+  REPLACE,   // layer pixel
+  ADD,       // sum, saturated
+  ALPHA,     // premultiplied, the brightest channel is the coverage if there's no plane
+  MULTIPLY,  // darkens what is below
+};
+
+// Inclusive pixel bounds, empty when x1 < x0
+struct LayerRect {
+  int16_t x0 = 0;
+  int16_t y0 = 0;
+  int16_t x1 = -1;
+  int16_t y1 = -1;
+
+  bool empty() const { return x1 < x0; }
+  bool contains(int16_t x, int16_t y) const {
+    return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+  }
+  uint32_t area() const { return empty() ? 0 : (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1); }
+
+  void add(int16_t x, int16_t y) {
+    if (empty()) {
+      x0 = x1 = x;
+      y0 = y1 = y;
+      return;
+    }
+    if (x < x0) x0 = x;
+    if (x > x1) x1 = x;
+    if (y < y0) y0 = y;
+    if (y > y1) y1 = y;
+  }
+
+  void unite(const LayerRect& r) {
+    if (r.empty())
+      return;
+    add(r.x0, r.y0);
+    add(r.x1, r.y1);
+  }
+};
+
+// Owns the layers a frame is built from and blends them, in one row major pass
+// over the area anything was drawn in, into a backend's PixelSink. Black means
+// nothing was drawn there, in every blend mode, as with GFX_LayerCompositor::
+// Stack(). Layers hold one frame: composite() clears them again.
+//
+// What was drawn is tracked in 8x8 pixel tiles, one bit each, so a few fish
+// spread over the panel don't make the whole frame count as drawn. Compositing
+// and clearing only touch those tiles.
+//
+// The GFX_Layers draw into these with their display(), see Matrix::displayInto().
+// A layer's RGB plane is only allocated once something is drawn into it.
+//
+// Anti-aliased shapes draw with blendPixel(), which gives the layer a coverage
+// plane as well. Where a layer has one, the pixel is premultiplied by its
+// coverage and the layers below show through the rest, in REPLACE mode too.
+class LayerCompositor {
+ public:
+  // Pixel counts summed over the frames since the last takeStats()
+  struct Stats {
+    uint32_t frames = 0;
+    uint32_t composited = 0;  // written to the sink
+    uint32_t cleared = 0;     // wiped in the layers afterwards
+  };
+
+  // Bulk writes into one layer, see PixelSink
+  struct LayerSink : PixelSink<LayerSink> {
+    LayerCompositor* compositor;
+    LayerId id;
+    LayerSink(LayerCompositor* compositor, LayerId id) : compositor(compositor), id(id) {}
+    inline void writePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+      compositor->writePixel(id, x, y, r, g, b);
+    }
+  };
+
+  ~LayerCompositor();
+
+  void begin(uint16_t width, uint16_t height);
+
+  inline void writePixel(LayerId id, int16_t x, int16_t y, uint8_t r, uint8_t g,
+                         uint8_t b) {
+    if (x < 0 || y < 0 || x >= width || y >= height)
+      return;
+
+    // Nothing drawn, so it doesn't wipe what other sources drew into the
+    // layer this frame either
+    if (!(r | g | b))
+      return;
+
+    Layer& layer = layers[id];
+    if (layer.pixels == nullptr && !allocate(layer))
+      return;
+
+    layer.pixels[y * width + x] = CRGB(r, g, b);
+    if (layer.coverage != nullptr)
+      layer.coverage[y * width + x] = 255;
+    layer.tiles[y >> TILE_SHIFT] |= 1UL << (x >> TILE_SHIFT);
+  }
+
+  // c over what the layer has at x, y by coverage (0-255). The colour is mixed
+  // in, so overlapping shapes keep their drawing order, while the coverage adds
+  // up (saturated), so a pixel two abutting edges share half each ends up solid.
+  inline void blendPixel(LayerId id, int16_t x, int16_t y, const CRGB& c, uint8_t coverage) {
+    if (x < 0 || y < 0 || x >= width || y >= height || !coverage || !(c.r | c.g | c.b))
+      return;
+
+    Layer& layer = layers[id];
+    if (layer.pixels == nullptr && !allocate(layer))
+      return;
+    if (layer.coverage == nullptr && !allocateCoverage(layer))
+      return;
+
+    uint32_t i = y * width + x;
+    CRGB& p = layer.pixels[i];
+    p = CRGB(mix(p.r, c.r, coverage), mix(p.g, c.g, coverage), mix(p.b, c.b, coverage));
+    uint8_t& a = layer.coverage[i];
+    a = a + coverage > 255 ? 255 : a + coverage;
+    layer.tiles[y >> TILE_SHIFT] |= 1UL << (x >> TILE_SHIFT);
+  }
+
+  // Pixels x0..x1 of row y, clipped to the layer
+  inline void fillSpan(LayerId id, int16_t y, int16_t x0, int16_t x1, const CRGB& c) {
+    if (y < 0 || y >= height || !(c.r | c.g | c.b))
+      return;
+    if (x0 < 0)
+      x0 = 0;
+    if (x1 >= width)
+      x1 = width - 1;
+    if (x0 > x1)
+      return;
+
+    Layer& layer = layers[id];
+    if (layer.pixels == nullptr && !allocate(layer))
+      return;
+
+    CRGB* p = &layer.pixels[y * width + x0];
+    for (int16_t n = x1 - x0; n >= 0; n--) {
+      *p++ = c;
+    }
+    if (layer.coverage != nullptr)
+      memset(&layer.coverage[y * width + x0], 255, x1 - x0 + 1);
+    uint8_t t0 = x0 >> TILE_SHIFT;
+    uint8_t t1 = x1 >> TILE_SHIFT;
+    uint32_t below_t1 = t1 >= 31 ? 0xFFFFFFFF : (1UL << (t1 + 1)) - 1;
+    layer.tiles[y >> TILE_SHIFT] |= below_t1 & ~((1UL << t0) - 1);
+  }
+
+  // Black where nothing was drawn, or the layer is out of range
+  CRGB getPixel(LayerId id, int16_t x, int16_t y) const {
+    const Layer& layer = layers[id];
+    if (x < 0 || y < 0 || x >= width || y >= height || layer.pixels == nullptr)
+      return CRGB(0, 0, 0);
+    return layer.pixels[y * width + x];
+  }
+
+  LayerSink sink(LayerId id) { return LayerSink(this, id); }
+
+  void setOpacity(LayerId id, uint8_t opacity) { layers[id].opacity = opacity; }
+  uint8_t getOpacity(LayerId id) const { return layers[id].opacity; }
+  void setBlendMode(LayerId id, BlendMode mode) { layers[id].mode = mode; }
+  BlendMode getBlendMode(LayerId id) const { return layers[id].mode; }
+  void setVisible(LayerId id, bool visible) { layers[id].visible = visible; }
+  bool isVisible(LayerId id) const { return layers[id].visible; }
+
+  // Bounds of the tiles drawn into since the layer was last cleared
+  LayerRect getDirty(LayerId id) const;
+
+  void clear(LayerId id);
+  void clearAll();
+
+  uint32_t pixelCount() const { return (uint32_t)width * height; }
+  Stats takeStats();
+
+  // Blend all layers into the sink and clear them. Only the tiles the visible
+  // layers drew in are written, unless whole_frame: for sinks that keep the
+  // last frame's pixels rather than starting out black.
+  template <class Sink>
+  void composite(Sink& sink, bool whole_frame = false) {
+    uint32_t composited = 0;
+
+    for (uint8_t ty = 0; ty < tile_rows; ty++) {
+      // Layers with anything in this row of tiles, bottom to top
+      const Layer* active[LAYER_COUNT];
+      uint8_t count = 0;
+      uint32_t mask = whole_frame ? all_tiles : 0;
+      for (const Layer& layer : layers) {
+        if (layer.visible && layer.opacity && layer.tiles[ty]) {
+          active[count++] = &layer;
+          mask |= layer.tiles[ty];
+        }
+      }
+      if (!mask)
+        continue;
+
+      int16_t y_end = min((int16_t)height, (int16_t)((ty + 1) << TILE_SHIFT));
+      for (int16_t y = ty << TILE_SHIFT; y < y_end; y++) {
+        for (uint32_t m = mask; m; m &= m - 1) {
+          uint8_t tx = __builtin_ctz(m);
+          uint32_t tile = 1UL << tx;
+          int16_t x_end = min((int16_t)width, (int16_t)((tx + 1) << TILE_SHIFT));
+
+          for (int16_t x = tx << TILE_SHIFT; x < x_end; x++) {
+            CRGB out(0, 0, 0);
+            uint32_t at = y * width + x;
+            for (uint8_t i = 0; i < count; i++) {
+              const Layer& layer = *active[i];
+              if (!(layer.tiles[ty] & tile))
+                continue;
+              const CRGB& pixel = layer.pixels[at];
+              if (layer.coverage != nullptr) {
+                if (layer.coverage[at]) {
+                  blend(out, pixel, layer.mode, layer.opacity, layer.coverage[at]);
+                }
+              } else if (pixel.r | pixel.g | pixel.b) {
+                uint8_t coverage = layer.mode == BlendMode::ALPHA
+                                       ? max(pixel.r, max(pixel.g, pixel.b))
+                                       : 255;
+                blend(out, pixel, layer.mode, layer.opacity, coverage);
+              }
+            }
+            sink.writePixel(x, y, out.r, out.g, out.b);
+          }
+          composited += x_end - (tx << TILE_SHIFT);
+        }
+      }
+    }
+
+    stats.frames++;
+    stats.composited += composited;
+    clearAll();
+  }
+
+ private:
+  // 8x8 pixel tiles, a row of them fits a uint32_t up to 256 pixels wide
+  static constexpr uint8_t TILE_SHIFT = 3;
+  static constexpr uint8_t MAX_TILE_ROWS = 32;
+
+  struct Layer {
+    CRGB* pixels = nullptr;  // width x height, row major
+    uint8_t* coverage = nullptr;  // same layout, once blendPixel() is used
+    uint32_t tiles[MAX_TILE_ROWS] = {};  // drawn tiles, bit n = tile column n
+    uint8_t opacity = 255;
+    BlendMode mode = BlendMode::REPLACE;
+    bool visible = true;
+    bool alloc_failed = false;
+  };
+
+  bool allocate(Layer& layer);
+  bool allocateCoverage(Layer& layer);
+
+  static inline uint8_t mix(uint8_t a, uint8_t b, uint8_t t) {
+    return (a * (255 - t) + b * t + 127) / 255;
+  }
+
+  static inline uint8_t blendChannel(uint8_t below, uint8_t pixel, BlendMode mode,
+                                     uint8_t coverage) {
+    switch (mode) {
+      case BlendMode::ADD:
+        return below + pixel > 255 ? 255 : below + pixel;
+      case BlendMode::MULTIPLY:
+        return (below * pixel + 127) / 255;
+      default:  // REPLACE, ALPHA: below shows through what the pixel doesn't cover
+        return coverage == 255 ? pixel : pixel + (below * (255 - coverage) + 127) / 255;
+    }
+  }
+
+  static inline void blend(CRGB& out, const CRGB& pixel, BlendMode mode, uint8_t opacity,
+                           uint8_t coverage) {
+    uint8_t r = blendChannel(out.r, pixel.r, mode, coverage);
+    uint8_t g = blendChannel(out.g, pixel.g, mode, coverage);
+    uint8_t b = blendChannel(out.b, pixel.b, mode, coverage);
+    if (opacity != 255) {
+      r = mix(out.r, r, opacity);
+      g = mix(out.g, g, opacity);
+      b = mix(out.b, b, opacity);
+    }
+    out = CRGB(r, g, b);
+  }
+
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint8_t tile_rows = 0;
+  uint32_t all_tiles = 0;
+  Layer layers[LAYER_COUNT];
+  Stats stats;
+};
@@ -12,53 +12,66 @@
 // CIE - Lookup table for converting between perceived LED brightness and PWM
 // https://gist.github.com/mathiasvr/19ce1d7b6caeab230934080ae1f1380e
 
-// 8 bit lookup table as we're only passing through 8 bit colour data so pointless to scale it up
-// to 14-bit or 16-bit values for mbi_set_pixel as it'll just take longer to load the data to the
-// panel because of more bit iterations.
-const uint16_t CIE[256] = {
-    0,    0,    0,    0,    0,    1,    1,    1,    1,    1,    1,    1,    1,    1,    2,    2,
-    2,    2,    2,    2,    2,    2,    2,    3,    3,    3,    3,    3,    3,    3,    3,    4,
-    4,    4,    4,    4,    4,    5,    5,    5,    5,    5,    6,    6,    6,    6,    6,    7,
-    7,    7,    7,    8,    8,    8,    8,    9,    9,    9,   10,   10,   10,   10,   11,   11,
-   11,   12,   12,   12,   13,   13,   13,   14,   14,   15,   15,   15,   16,   16,   17,   17,
-   17,   18,   18,   19,   19,   20,   20,   21,   21,   22,   22,   23,   23,   24,   24,   25,
-   25,   26,   26,   27,   28,   28,   29,   29,   30,   31,   31,   32,   32,   33,   34,   34,
-   35,   36,   37,   37,   38,   39,   39,   40,   41,   42,   43,   43,   44,   45,   46,   47,
-   47,   48,   49,   50,   51,   52,   53,   54,   54,   55,   56,   57,   58,   59,   60,   61,
-   62,   63,   64,   65,   66,   67,   68,   70,   71,   72,   73,   74,   75,   76,   77,   79,
-   80,   81,   82,   83,   85,   86,   87,   88,   90,   91,   92,   94,   95,   96,   98,   99,
-  100,  102,  103,  105,  106,  108,  109,  110,  112,  113,  115,  116,  118,  120,  121,  123,
-  124,  126,  128,  129,  131,  132,  134,  136,  138,  139,  141,  143,  145,  146,  148,  150,
-  152,  154,  155,  157,  159,  161,  163,  165,  167,  169,  171,  173,  175,  177,  179,  181,
-  183,  185,  187,  189,  191,  193,  196,  198,  200,  202,  204,  207,  209,  211,  214,  216,
-  218,  220,  223,  225,  228,  230,  232,  235,  237,  240,  242,  245,  247,  250,  252,  255,
-};
-
-UMatrix::UMatrix() {
+// Same CIE 1931 curve, but at 16-bit resolution so dark colours keep their
+// steps in the 14-bit greyscale mode. Built once, then scaled per channel into
+// the colour LUT (see mbi_update_colour_lut()).
+static uint16_t CIE[256];
+
+static void build_cie_table() {
+  for (int i = 0; i < 256; i++) {
+    float L = i * 100.0f / 255.0f;
+    float Y = (L <= 8.0f) ? L / 903.3f : powf((L + 16.0f) / 116.0f, 3.0f);
+    CIE[i] = (uint16_t)(Y * 65535.0f + 0.5f);
+  }
+}
+
+// MBI5153 control sequences. They only depend on the chain length and the
+// register values, so they are built once and kept apart from the greyscale
+// buffers.
+DMA_ATTR static ESP32_GREY_DMA_STORAGE_TYPE cmd_pre_active[MBI_PRE_ACTIVE_LEN];
+DMA_ATTR static ESP32_GREY_DMA_STORAGE_TYPE cmd_v_sync[MBI_V_SYNC_LEN];
+DMA_ATTR static ESP32_GREY_DMA_STORAGE_TYPE cmd_soft_reset[MBI_SOFT_RESET_LEN];
+DMA_ATTR static ESP32_GREY_DMA_STORAGE_TYPE cmd_config_reg1[MBI_CONFIG_REG_MAX_LEN];
+DMA_ATTR static ESP32_GREY_DMA_STORAGE_TYPE cmd_config_reg2[MBI_CONFIG_REG_MAX_LEN];
+
+UMatrix::UMatrix(const MBI_PanelGeometry& panel_geometry)
+    : geometry(panel_geometry.isValid() ? panel_geometry : MBI_PanelGeometry()),
+      encoder(geometry) {
   fontSize = 2;
   rotation = 0;
 
+  compositor.begin(geometry.res_x, geometry.res_y);
+
+  // GFX_Lite keeps a layer's pixels to itself and only hands them out one by
+  // one through this std::function, so display() can't be a templated blit.
+  // Benchmark::pixelSink() times what that costs. The compositor's output goes
+  // through the sink directly.
   background =
-      new GFX_Layer(PANEL_RES_X, PANEL_RES_Y,
-                    [this](int16_t x, int16_t y, uint8_t r, uint8_t g,
-                           uint8_t b) { mbi_set_pixel(x, y, r, g, b); });
+      new GFX_Layer(geometry.res_x, geometry.res_y,
+                    [this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+                      compositor.writePixel(background_target, x, y, r, g, b);
+                    });
 
   foreground =
-      new GFX_Layer(PANEL_RES_X, PANEL_RES_Y,
-                    [this](int16_t x, int16_t y, uint8_t r, uint8_t g,
-                           uint8_t b) { mbi_set_pixel(x, y, r, g, b); });
+      new TrackedLayer(geometry.res_x, geometry.res_y,
+                       [this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+                         compositor.writePixel(foreground_target, x, y, r, g, b);
+                       });
 
   gfx_compositor = new GFX_LayerCompositor(
       [this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
-        mbi_set_pixel(x, y, r, g, b);
+        compositor.writePixel(background_target, x, y, r, g, b);
       });
 }
 
 void UMatrix::init() {
+  log_i("Panel geometry: %ux%u, %u scan lines, %u chained MBI5153s",
+        geometry.res_x, geometry.res_y, geometry.scan_lines,
+        geometry.chain_len);
+
   // Step 1) Allocate raw buffer space for MBI5153 greyscale / MBI chip
   // command /  pixel memory
-  dma_grey_buffer_parallel_bit_length =
-      ((PANEL_SCAN_LINES * PANEL_MBI_RES_X * 16));
+  dma_grey_buffer_parallel_bit_length = geometry.greyWords();
   dma_grey_buffer_size =
       sizeof(ESP32_GREY_DMA_STORAGE_TYPE) *
       dma_grey_buffer_parallel_bit_length;  // add some extract blank data at
@@ -70,13 +83,55 @@ void UMatrix::init() {
       "%lu bytes.",
       dma_grey_buffer_size);
 
-  // Malloc Greyscale / Command DMA Memory
-  dma_grey_gpio_data = (ESP32_GREY_DMA_STORAGE_TYPE*)heap_caps_malloc(
-      dma_grey_buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
-  assert(dma_grey_gpio_data != nullptr);
+  // Malloc Greyscale / Command DMA Memory, front and back
+  for (int i = 0; i < 2; i++) {
+    dma_grey_buffers[i] = (ESP32_GREY_DMA_STORAGE_TYPE*)heap_caps_malloc(
+        dma_grey_buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    assert(dma_grey_buffers[i] != nullptr);
 
-  // Fill with zeros to start with
-  memset(dma_grey_gpio_data, 0, dma_grey_buffer_size);
+    // Fill with zeros to start with
+    memset(dma_grey_buffers[i], 0, dma_grey_buffer_size);
+  }
+  dma_grey_back = 0;
+  dma_grey_gpio_data = dma_grey_buffers[dma_grey_back];
+
+  // Step 2) RGB framebuffer the layers draw into, encoded once per frame
+  framebuffer = (CRGB*)heap_caps_calloc(encoder.pixelCount() + 1,
+                                        sizeof(CRGB), MALLOC_CAP_INTERNAL);
+  assert(framebuffer != nullptr);
+  frames[frame_slots.writeSlot()] = framebuffer;
+  present_lock = xSemaphoreCreateMutex();
+  assert(present_lock != nullptr);
+  shown_frame = (CRGB*)heap_caps_calloc(encoder.pixelCount(), sizeof(CRGB),
+                                        MALLOC_CAP_INTERNAL);
+  assert(shown_frame != nullptr);
+  mbi_invalidate_rows();
+  build_cie_table();
+  applied_scan_mode = scan_mode;
+  scan_mode_dirty = false;
+  grey_mask = scan_mode.grey_13bit ? PANEL_GREY_MASK_13 : PANEL_GREY_MASK_14;
+  mbi_split_brightness();
+  mbi_update_colour_lut();
+  applied_brightness = brightness;
+
+  // Step 3) Pixel address map
+  const char* address_map_mem = "internal RAM";
+#ifdef PANEL_ADDRESS_MAP_PSRAM
+  address_map =
+      (uint16_t*)heap_caps_malloc(getAddressMapBytes(), MALLOC_CAP_SPIRAM);
+  if (address_map == nullptr) {
+    log_e("No PSRAM for the address map, using internal RAM");
+  } else {
+    address_map_mem = "PSRAM";
+  }
+#endif
+  if (address_map == nullptr) {
+    address_map =
+        (uint16_t*)heap_caps_malloc(getAddressMapBytes(), MALLOC_CAP_INTERNAL);
+  }
+  assert(address_map != nullptr);
+  mbi_build_address_map();
+  log_i("Address map: %u bytes in %s", getAddressMapBytes(), address_map_mem);
 
   // Setup LCD DMA and Output to GPIO
   auto bus_cfg = dma_bus.config();
@@ -101,9 +156,11 @@ void UMatrix::init() {
 
   dma_bus.config(bus_cfg);
   dma_bus.setup_lcd_dma_periph();
+  mbi_setup_dma_chains();
 
   // Setup SPI DMA Output for GCLK and Address Lines
-  spi_setup();
+  spi_setup(geometry.scan_lines, applied_scan_mode.gclksPerRow());
+  mbi_log_scan_timing();
 
   updateRegisters();
 
@@ -112,39 +169,64 @@ void UMatrix::init() {
   initialized = true;
 }
 
+// Payload sizes never change, so every descriptor chain is built exactly once
+void UMatrix::mbi_setup_dma_chains() {
+  mbi_build_commands();
+  dma_bus.create_dma_chain(pre_active_chain, cmd_pre_active,
+                           sizeof(cmd_pre_active));
+  dma_bus.create_dma_chain(v_sync_chain, cmd_v_sync, sizeof(cmd_v_sync));
+
+  // Each greyscale frame ends in the vsync that shows it, in the same transfer
+  for (int i = 0; i < 2; i++) {
+    dma_bus.create_dma_chain(grey_chains[i], dma_grey_buffers[i],
+                             dma_grey_buffer_size);
+    dma_bus.append_dma_chain(grey_chains[i], v_sync_chain);
+  }
+  dma_bus.create_dma_chain(soft_reset_chain, cmd_soft_reset,
+                           sizeof(cmd_soft_reset));
+  // Config registers are shifted through the whole chain, 16 bits per IC
+  const size_t config_reg_bytes =
+      MBI_Commands::configWords(geometry) * sizeof(ESP32_GREY_DMA_STORAGE_TYPE);
+  dma_bus.create_dma_chain(config_reg1_chain, cmd_config_reg1,
+                           config_reg_bytes);
+  dma_bus.create_dma_chain(config_reg2_chain, cmd_config_reg2,
+                           config_reg_bytes);
+}
+
+void UMatrix::mbi_build_commands() {
+  MBI_Commands::preActive(cmd_pre_active);
+  MBI_Commands::vSync(cmd_v_sync);
+  MBI_Commands::softReset(cmd_soft_reset);
+
+  // Config registers, shifted through the whole chain, latched by the last IC
+  mbi_build_config_reg1();
+  MBI_Commands::config(cmd_config_reg2, geometry, MBI_CONFIG_REG2_VALUE, true);
+}
+
+// Register 1 carries the current gain, rebuilt when the brightness needs it
+void UMatrix::mbi_build_config_reg1() {
+  MBI_Commands::config(cmd_config_reg1, geometry, mbi_config_reg1_value(), false);
+}
+
 uint8_t UMatrix::getXResolution() {
-  return PANEL_RES_X;
+  return geometry.res_x;
 }
 
 uint8_t UMatrix::getYResolution() {
-  return PANEL_RES_Y;
+  return geometry.res_y;
+}
+
+uint8_t UMatrix::getScanLines() const {
+  return geometry.scan_lines;
 }
 
 void UMatrix::drawPixelRGB888(uint16_t x, uint16_t y, uint8_t r_data,
                               uint8_t g_data, uint8_t b_data) {
-  mbi_set_pixel(x, y, r_data, g_data, b_data);
+  compositor.writePixel(LAYER_BACKGROUND, x, y, r_data, g_data, b_data);
 }
 
 void UMatrix::transform(int16_t& x, int16_t& y, int16_t& w, int16_t& h) {
-  int16_t temp;
-  switch (rotation) {
-    case 1:  // 90 degrees clockwise
-      temp = x;
-      x = y;
-      y = PANEL_RES_X - 1 - temp;
-      break;
-    case 2:  // 180 degrees
-      x = PANEL_RES_X - 1 - x;
-      y = PANEL_RES_Y - 1 - y;
-      break;
-    case 3:  // 270 degrees clockwise
-      temp = x;
-      x = PANEL_RES_Y - 1 - y;
-      y = temp;
-      break;
-    default:  // No rotation
-      break;
-  }
+  encoder.rotate(x, y, rotation);
 }
 
 void UMatrix::setBrightness(uint8_t newBrightness) {
@@ -158,61 +240,381 @@ uint8_t UMatrix::getBrightness() const {
 void UMatrix::setRotation(uint8_t newRotation) {
   if (newRotation < 4 && newRotation != rotation) {
     rotation = newRotation;
-    refreshMatrixConfig();
+    content_generation++;
+    mbi_build_address_map();
   }
 }
 
 void UMatrix::rotate90() {
   rotation = (rotation + 1) % 4;
+  content_generation++;
+  mbi_build_address_map();
+}
+
+void UMatrix::setMirror(bool horizontal, bool vertical) {
+  if (horizontal != mirror_x || vertical != mirror_y) {
+    mirror_x = horizontal;
+    mirror_y = vertical;
+    content_generation++;
+    mbi_build_address_map();
+  }
+}
+
+size_t UMatrix::getAddressMapBytes() const {
+  return geometry.res_x * geometry.res_y * sizeof(uint16_t);
+}
+
+void UMatrix::mbi_build_address_map() {
+  if (address_map == nullptr)
+    return;
+
+  encoder.buildAddressMap(address_map, rotation, mirror_x, mirror_y);
 }
 
 void UMatrix::clearScreen() {
-  memset(dma_grey_gpio_data, 0, dma_grey_buffer_size);
+  compositor.clearAll();
+  memset(framebuffer, 0, encoder.pixelCount() * sizeof(CRGB));
 }
 
 void UMatrix::update() {
   assert(initialized);
-
-  mbi_update_frame(true);
-  spi_transfer_loop_stop();
-  mbi_v_sync_dma();
-  spi_transfer_loop_start();
+  int64_t stamp = esp_timer_get_time();
+
+  compositor.composite(sink);
+
+  if (pipelined) {
+    // Hand the frame over to the encoder task and carry on with the next one
+    frame_stamp[frame_slots.writeSlot()] = stamp;
+    bool replaced = false;
+    framebuffer = frames[frame_slots.publish(&replaced)];
+    if (replaced) {
+      portENTER_CRITICAL(&frame_stats_lock);
+      frame_stats.dropped++;
+      portEXIT_CRITICAL(&frame_stats_lock);
+    }
+    xTaskNotifyGive(encoder_task);
+  } else {
+    xSemaphoreTake(present_lock, portMAX_DELAY);
+    mbi_present(framebuffer, stamp);
+    xSemaphoreGive(present_lock);
+  }
 
   // log_e("tsfr count: %d", dma_bus.get_transfer_count());
 
   clearScreen();
 }
 
-void UMatrix::mbi_update_frame(bool configure_latches) {
-  int counter = 0;
-  for (int row = 0; row < PANEL_SCAN_LINES; row++) {
-    for (int chan = 0; chan < PANEL_MBI_LED_CHANS; chan++) {
-      for (int ic = 0; ic < PANEL_MBI_CHAIN_LEN;
-           ic++) {  // number of chained ICs
-
-        // data latch on the last bit, when sending the last byte set latch=1
-        int latch = 0;
-        if (ic == 4) {
-          latch = 1;
-        }  // latch on last channel / ic
-
-        int bit_offset = 16;
-        while (bit_offset > 0)  // shift out MSB first per the documentation.
-        {
-          bit_offset--;  // start from 15
-
-          if (latch == 1 && bit_offset == 0) {
-            dma_grey_gpio_data[counter] |= BIT_LAT;
-          }
-          counter++;
-        }
+// The layers didn't draw anything. The last frame is on the panel already, its
+// vsync went out with it. A brightness, colour or scan mode change still has
+// to reach the panel, so the last frame is sent again for those.
+void UMatrix::holdFrame() {
+  idle_frames++;
+
+  if (brightness == applied_brightness && !colour_lut_dirty && !scan_mode_dirty)
+    return;
+
+  // shown_frame may be older than a frame the encoder task hasn't taken yet,
+  // so it presents its newest frame again itself rather than being handed this
+  if (pipelined) {
+    hold_requested = true;
+    xTaskNotifyGive(encoder_task);
+    return;
+  }
+
+  xSemaphoreTake(present_lock, portMAX_DELAY);
+  memcpy(framebuffer, shown_frame, encoder.pixelCount() * sizeof(CRGB));
+  xSemaphoreGive(present_lock);
+  update();
+}
+
+// Encode this frame into the back buffer while the previous one is still
+// being clocked out, then wait for that transfer and send this one. The layers
+// have been drawing in the meantime as well, so we only block here if the
+// previous frame is still going after all that. Called with present_lock held.
+void UMatrix::mbi_present(const CRGB* frame, int64_t stamp) {
+  uint32_t waited = 0;
+
+  // Register writes need an idle bus, and a new colour LUT has to be in place
+  // before encoding. Those frames wait first.
+  if (scan_mode_dirty || colour_lut_dirty || applied_brightness != brightness) {
+    waited = dma_bus.wait_transfer_done();
+    mbi_apply_scan_mode();
+    mbi_apply_brightness();
+    if (colour_lut_dirty) {
+      mbi_update_colour_lut();
+    }
+  }
+
+  if (mbi_encode_frame(frame)) {
+    waited += dma_bus.wait_transfer_done();
+    mbi_send_frame();
+  }
+  frame_wait_us = waited;
+
+  uint32_t latency = esp_timer_get_time() - stamp;
+  portENTER_CRITICAL(&frame_stats_lock);
+  frame_stats.frames++;
+  frame_stats.latency_us += latency;
+  frame_stats.wait_us += frame_wait_us;
+  frame_stats.encoded_rows += frame_encoded_rows;
+  if (frame_encoded_rows == 0) {
+    frame_stats.unchanged++;
+  }
+  portEXIT_CRITICAL(&frame_stats_lock);
+}
+
+// Pinned to core 0, while the display task renders on core 1. Woken by
+// update(), always presents the newest frame handed over. Woken by holdFrame()
+// with nothing new, presents the frame it took last once more.
+void UMatrix::encoderTask(void* arg) {
+  UMatrix* m = (UMatrix*)arg;
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    xSemaphoreTake(m->present_lock, portMAX_DELAY);
+    if (m->pipelined) {
+      bool fresh = m->frame_slots.consume();
+      if (fresh || m->hold_requested) {
+        m->hold_requested = false;
+        uint8_t slot = m->frame_slots.readSlot();
+        m->mbi_present(m->frames[slot], fresh ? m->frame_stamp[slot] : esp_timer_get_time());
+      }
+    }
+    xSemaphoreGive(m->present_lock);
+  }
+}
+
+void UMatrix::setPipelined(bool enabled) {
+  if (enabled == pipelined)
+    return;
+
+  if (!enabled) {
+    pipelined = false;
+    // A frame the encoder task is presenting right now is finished first
+    xSemaphoreTake(present_lock, portMAX_DELAY);
+    xSemaphoreGive(present_lock);
+    return;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    if (frames[i] == nullptr) {
+      frames[i] = (CRGB*)heap_caps_calloc(encoder.pixelCount() + 1,
+                                          sizeof(CRGB), MALLOC_CAP_INTERNAL);
+      if (frames[i] == nullptr) {
+        log_e("Not enough memory for the frame pipeline");
+        return;
       }
     }
   }
+  if (encoder_task == nullptr) {
+    xTaskCreatePinnedToCore(encoderTask, "EncoderTask", 4096, this, 2,
+                            &encoder_task, 0);
+    if (encoder_task == nullptr) {
+      log_e("Couldn't start the encoder task");
+      return;
+    }
+  }
+
+  pipelined = true;
+  log_i("Frame pipeline on, encoding on core 0");
+}
+
+UMatrix::FrameStats UMatrix::takeFrameStats() {
+  portENTER_CRITICAL(&frame_stats_lock);
+  FrameStats stats = frame_stats;
+  frame_stats = FrameStats();
+  portEXIT_CRITICAL(&frame_stats_lock);
+  return stats;
+}
+
+uint32_t UMatrix::getFrameWaitUs() const {
+  return frame_wait_us;
+}
+
+uint8_t UMatrix::getFrameEncodedRows() const {
+  return frame_encoded_rows;
+}
+
+// The frame's vsync is part of its transfer, so once that is done the frame
+// is on the panel
+void UMatrix::mbi_finish_frame() {
+  frame_wait_us = dma_bus.wait_transfer_done();
+}
+
+// Returns false if there is nothing to send
+bool UMatrix::mbi_encode_frame(const CRGB* frame) {
+  uint32_t changed = mbi_find_changed_rows(frame);
+  grey_stale_rows[0] |= changed;
+  grey_stale_rows[1] |= changed;
+
+  // The panel already shows this frame, leave the DMA alone
+  if (changed == 0 && !frame_force_send) {
+    frame_encoded_rows = 0;
+    return false;
+  }
+  frame_force_send = false;
+
+  // The back buffer was last written two frames ago, so bring every scan line
+  // it is missing up to date, not just the ones that changed now. The MBI5153
+  // takes greyscale data in scan order from the start of the frame, so the
+  // whole buffer is still sent.
+  uint32_t rows = grey_stale_rows[dma_grey_back];
+  encoder.encodeRows((const uint8_t*)frame, dma_grey_gpio_data, rows);
+  grey_stale_rows[dma_grey_back] = 0;
+  frame_encoded_rows = __builtin_popcount(rows);
+
+  return true;
+}
 
+// The bus has to be idle
+void UMatrix::mbi_send_frame() {
   // log_d(TAG, "Sending greyscale data buffer out via LCD DMA.");
-  dma_bus.send_stuff_once(dma_grey_gpio_data, dma_grey_buffer_size,
-                          true);  // sending payload hence TRUE
+  dma_bus.send_chain_async(grey_chains[dma_grey_back]);
+
+  // The buffer just submitted is off limits until the transfer is done
+  dma_grey_back ^= 1;
+  dma_grey_gpio_data = dma_grey_buffers[dma_grey_back];
+}
+
+// Scan lines whose pixels differ from the last frame sent, shown_frame is
+// brought up to date on the way
+uint32_t UMatrix::mbi_find_changed_rows(const CRGB* frame) {
+  const size_t row_bytes = encoder.rowSlots() * sizeof(CRGB);
+  uint32_t changed = 0;
+
+  for (int row = 0; row < geometry.scan_lines; row++) {
+    const CRGB* current = frame + row * encoder.rowSlots();
+    CRGB* shown = shown_frame + row * encoder.rowSlots();
+    if (memcmp(current, shown, row_bytes) != 0) {
+      memcpy(shown, current, row_bytes);
+      changed |= 1UL << row;
+    }
+  }
+
+  return changed;
+}
+
+// Everything has to be encoded again, e.g. after a colour LUT change
+void UMatrix::mbi_invalidate_rows() {
+  grey_stale_rows[0] = grey_stale_rows[1] = geometry.allRows();
+  frame_force_send = true;
+}
+
+// CIE correction, white balance and the software part of the brightness
+// folded into one 8-bit -> 16-bit lookup per colour channel. 768 entries, so
+// cheap enough to rebuild on every brightness step.
+void UMatrix::mbi_update_colour_lut() {
+  colour_lut_dirty = false;
+
+  uint32_t scale[3];
+  for (int c = 0; c < 3; c++) {
+    scale[c] = white_balance[c] * soft_brightness;  // 255 * 255 = unity
+  }
+
+  for (int i = 0; i < 256; i++) {
+    for (int c = 0; c < 3; c++) {
+      colour_lut[c][i] = ((uint32_t)CIE[i] * scale[c] / (255 * 255)) & grey_mask;
+    }
+  }
+  encoder.setColourLut(colour_lut[0], colour_lut[1], colour_lut[2]);
+  mbi_invalidate_rows();
+}
+
+void UMatrix::setScanMode(const MBI_ScanMode& mode) {
+  if (!geometry.isValid(mode.gclksPerRow())) {
+    log_e("Scan mode doesn't fit the panel geometry");
+    return;
+  }
+  scan_mode = mode;
+  scan_mode_dirty = true;  // picked up by the next update()
+}
+
+MBI_ScanMode UMatrix::getScanMode() const {
+  return scan_mode;
+}
+
+// Called between frames, with no transfer in flight. The MBI5153 is told
+// first, then the GCLK payload is rebuilt to match and the SPI loop restarted.
+void UMatrix::mbi_apply_scan_mode() {
+  if (!scan_mode_dirty)
+    return;
+  scan_mode_dirty = false;
+
+  MBI_ScanMode mode = scan_mode;
+  if (mode == applied_scan_mode)
+    return;
+
+  applied_scan_mode = mode;
+  mbi_build_config_reg1();
+  mbi_pre_active_dma();
+  mbi_send_config_reg1_dma();
+
+  spi_set_gclks_per_row(mode.gclksPerRow());
+
+  grey_mask = mode.grey_13bit ? PANEL_GREY_MASK_13 : PANEL_GREY_MASK_14;
+  mbi_update_colour_lut();
+
+  mbi_log_scan_timing();
+}
+
+// A row takes its GCLKs plus padding, one payload byte per SPI clock. Every
+// grey level is shown after 2^bits / (grey counts per row) scans.
+void UMatrix::mbi_log_scan_timing() {
+  const MBI_ScanMode& mode = applied_scan_mode;
+  int gclks = mode.gclksPerRow();
+  float row_us =
+      (spi_get_payload_size() / (float)geometry.scan_lines) * 1e6f / PANEL_GCLK_SPI_HZ;
+  float scan_us = row_us * geometry.scan_lines;
+  int counts_per_row = (gclks - 1) * (mode.gclk_multiplier ? 2 : 1);
+  int scans_per_frame = (1 << mode.greyBits()) / counts_per_row;
+  float frame_us = scan_us * scans_per_frame;
+
+  log_i("Scan mode: %d GCLKs/row, %d-bit greyscale", gclks, mode.greyBits());
+  log_i("Row %.1f us, scan %.2f ms (%.0f Hz refresh), all grey levels every %.1f ms (%.1f Hz)",
+        row_us, scan_us / 1000, 1e6f / scan_us, frame_us / 1000, 1e6f / frame_us);
+}
+
+void UMatrix::setWhiteBalance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain) {
+  white_balance[0] = r_gain;
+  white_balance[1] = g_gain;
+  white_balance[2] = b_gain;
+  colour_lut_dirty = true;  // picked up by the next update()
+}
+
+// The LED current scales with (gain + 1) / 64, so most of the range is covered
+// by the MBI5153 current gain and keeps the full greyscale resolution. Only
+// levels under current_gain_min are scaled down in software.
+void UMatrix::mbi_split_brightness() {
+  int gain = (brightness * (brightness_base + 1) + 254) / 255 - 1;
+
+  if (gain < current_gain_min) {
+    current_gain = current_gain_min;
+    soft_brightness =
+        brightness * (brightness_base + 1) / (current_gain_min + 1);
+  } else {
+    current_gain = gain;
+    soft_brightness = 255;
+  }
+}
+
+// Called between frames, with no transfer in flight. Free unless the level
+// changed since the last frame.
+void UMatrix::mbi_apply_brightness() {
+  if (applied_brightness == brightness)
+    return;
+
+  uint8_t previous_gain = current_gain;
+  mbi_split_brightness();
+
+  if (current_gain != previous_gain) {
+    mbi_build_config_reg1();
+    mbi_pre_active_dma();
+    mbi_send_config_reg1_dma();
+  }
+
+  mbi_update_colour_lut();
+  applied_brightness = brightness;
 }
 
 void UMatrix::updateRegisters() {
@@ -229,65 +631,56 @@ void UMatrix::updateRegisters() {
 
   // MBI Step 3) Clean out any crap in the greyscale buffer
   mbi_soft_reset_dma();  // 10 clocks
-
-  memset(dma_grey_gpio_data, 0,
-         dma_grey_buffer_size);  // accidenty display configuration registers
-                                 // id we don't clear th
 }
 
 void UMatrix::refreshMatrixConfig() {
+  xSemaphoreTake(present_lock, portMAX_DELAY);
+  mbi_finish_frame();
   mbi_pre_active_dma();
   mbi_send_config_reg1_dma();
+  xSemaphoreGive(present_lock);
 }
 
+// Per-pixel encoder, writes straight into the greyscale DMA buffer. Replaced
+// by MBI_FrameEncoder, only kept as the baseline for the timings in
+// Benchmark::frameEncoder(). The encoder is checked against this layout in
+// test/test_frame_encoder.
 void UMatrix::mbi_set_pixel(uint8_t x, uint8_t y, uint8_t _r_data,
                             uint8_t _g_data, uint8_t _b_data) {
-  if (x >= PANEL_RES_X || x < 0 || y >= PANEL_RES_Y || y < 0)
+  if (x >= geometry.res_x || y >= geometry.res_y)
     return;
 
-  uint8_t r_data = CIE[_r_data];
-  uint8_t g_data = CIE[_g_data];
-  uint8_t b_data = CIE[_b_data];
-
-  int16_t _x = x, _y = y;
-  int16_t _w = PANEL_RES_X, _h = PANEL_RES_Y;
-  transform(_x, _y, _w, _h);
-  CRGB color = CRGB(r_data, g_data, b_data);
-  color.nscale8(brightness);
+  uint16_t r_data = colour_lut[0][_r_data];
+  uint16_t g_data = colour_lut[1][_g_data];
+  uint16_t b_data = colour_lut[2][_b_data];
 
-  // Merged mbi_set_pixel functionality
-  if (_x >= PANEL_MBI_RES_X || _y >= PANEL_MBI_RES_Y) {
-    log_e("Pixel position out of bounds: x=%u, y=%u", _x, _y);
+  uint16_t slot = address_map[y * geometry.res_x + x];
+  if (slot >= encoder.pixelCount())
     return;
-  }
-
-  _x += 2;  // offset for missing pixels on the left
-
-  uint16_t _colourbitsoffset = (_y / PANEL_SCAN_LINES) * 3;
+  uint16_t _colourbitsoffset = MBI_FrameEncoder::laneShift(slot);
   uint16_t _colourbitsclear = ~(0b111 << _colourbitsoffset);
 
   uint16_t g_gpio_bitmask = BIT_G1 << _colourbitsoffset;
   uint16_t b_gpio_bitmask = BIT_B1 << _colourbitsoffset;
   uint16_t r_gpio_bitmask = BIT_R1 << _colourbitsoffset;
 
-  int y_normalised = _y % PANEL_SCAN_LINES;
-  int bit_start_pos = (1280 * y_normalised) + ((_x % 16) * 80) + ((_x / 16) * 16);
+  int bit_start_pos = MBI_FrameEncoder::wordOffset(slot);
 
-  int subpixel_colour_bit = 8;
-  uint8_t mask;
+  int subpixel_colour_bit = PANEL_MBI_GREY_BITS;
+  uint16_t mask;
   while (subpixel_colour_bit > 0) {
     subpixel_colour_bit--;
     dma_grey_gpio_data[bit_start_pos] &= _colourbitsclear;
 
     mask = 1 << subpixel_colour_bit;
 
-    if (color.g & mask) {
+    if (g_data & mask) {
       dma_grey_gpio_data[bit_start_pos] |= g_gpio_bitmask;
     }
-    if (color.b & mask) {
+    if (b_data & mask) {
       dma_grey_gpio_data[bit_start_pos] |= b_gpio_bitmask;
     }
-    if (color.r & mask) {
+    if (r_data & mask) {
       dma_grey_gpio_data[bit_start_pos] |= r_gpio_bitmask;
     }
 
@@ -297,99 +690,23 @@ void UMatrix::mbi_set_pixel(uint8_t x, uint8_t y, uint8_t _r_data,
 
 void UMatrix::mbi_pre_active_dma() {
   // log_d("Sending MBI Pre-Active.");
-  int payload_length = 0;
-  for (int i = 0; i < 14; i++) {
-    dma_grey_gpio_data[payload_length++] = BIT_LAT;
-  }
-
-  for (int i = 0; i < 2; i++) {
-    dma_grey_gpio_data[payload_length++] = 0x00;
-  }
-
-  dma_bus.send_stuff_once(dma_grey_gpio_data,
-                          payload_length * sizeof(ESP32_GREY_DMA_STORAGE_TYPE),
-                          false);
-}
-
-void UMatrix::mbi_v_sync_dma() {
-  // log_d("Sending MBI Vert Sync.");
-  int payload_length = 600;
-  memset(dma_grey_gpio_data, 0,
-         payload_length * sizeof(ESP32_GREY_DMA_STORAGE_TYPE));
-
-  int start_pos = payload_length - (payload_length / 2);
-  for (int i = 0; i < 3; i++) {
-    dma_grey_gpio_data[start_pos++] = BIT_LAT;
-  }
-  dma_grey_gpio_data[start_pos] = 0x00;
-
-  dma_bus.send_stuff_once(dma_grey_gpio_data,
-                          payload_length * sizeof(ESP32_GREY_DMA_STORAGE_TYPE),
-                          false);
+  dma_bus.send_chain_once(pre_active_chain);
 }
 
 void UMatrix::mbi_soft_reset_dma() {
   // log_d("Sending MBI Soft Reset.");
-  int payload_length = 0;
-  for (int i = 0; i < 10; i++) {
-    dma_grey_gpio_data[payload_length++] = BIT_LAT;
-  }
-  dma_grey_gpio_data[payload_length++] = 0x00;
-
-  dma_bus.send_stuff_once(dma_grey_gpio_data,
-                          payload_length * sizeof(ESP32_GREY_DMA_STORAGE_TYPE),
-                          false);
+  dma_bus.send_chain_once(soft_reset_chain);
 }
 
-void UMatrix::mbi_set_config_dma(unsigned int& dma_output_pos,
-                                 uint16_t config_reg, bool latch, bool reg2) {
-  // log_d("Sending MBI Config DMA.");
-  int latch_trigger_point = reg2 ? 8 : 4;
-
-  for (int bit = 15; bit >= 0; bit--) {
-    int bitval = (config_reg >> bit) & 1;
-    uint16_t mbi_rgb_sdi_val = bitval ? BIT_ALL_RGB : 0;
-
-    if (bit < latch_trigger_point && latch) {
-      mbi_rgb_sdi_val |= BIT_LAT;
-    }
-
-    dma_grey_gpio_data[dma_output_pos++] = mbi_rgb_sdi_val;
-  }
+uint16_t UMatrix::mbi_config_reg1_value() const {
+  return MBI_Commands::configReg1(geometry, applied_scan_mode, current_gain);
 }
 
 void UMatrix::mbi_send_config_reg1_dma() {
-  uint16_t config_reg1_val = 0;
-  int ghost_elimination = ghost_elimination_ON;
-  int line_num = PANEL_SCAN_LINES - 1;
-  int gray_scale = gray_scale_14;
-  int gclk_multiplier = gclk_multiplier_OFF;
-  int current = brightness_base;
-
-  config_reg1_val = (ghost_elimination << 14) | (line_num << 8) |
-                    (gray_scale << 7) | (gclk_multiplier << 6) | current;
-
-  unsigned int dma_output_pos = 0;
-  for (int i = 0; i < PANEL_MBI_CHAIN_LEN; i++) {
-    mbi_set_config_dma(dma_output_pos, config_reg1_val,
-                       i == (PANEL_MBI_CHAIN_LEN - 1), false);
-  }
-
-  dma_bus.send_stuff_once(dma_grey_gpio_data,
-                          dma_output_pos * sizeof(ESP32_GREY_DMA_STORAGE_TYPE),
-                          false);
+  // log_d("Sending MBI Config DMA.");
+  dma_bus.send_chain_once(config_reg1_chain);
 }
 
 void UMatrix::mbi_send_config_reg2_dma() {
-  uint16_t config_reg2_val = 0b1001000000011110;
-  unsigned int dma_output_pos = 0;
-
-  for (int i = 0; i < PANEL_MBI_CHAIN_LEN; i++) {
-    mbi_set_config_dma(dma_output_pos, config_reg2_val,
-                       i == (PANEL_MBI_CHAIN_LEN - 1), true);
-  }
-
-  dma_bus.send_stuff_once(dma_grey_gpio_data,
-                          dma_output_pos * sizeof(ESP32_GREY_DMA_STORAGE_TYPE),
-                          false);
+  dma_bus.send_chain_once(config_reg2_chain);
 }
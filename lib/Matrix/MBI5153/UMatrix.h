@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include "UMatrixSettings.hpp"
+#include "UMatrixPins.hpp"
 #include "GFX_Layer.hpp"
 #include "Matrix.h"
 
@@ -12,21 +13,58 @@
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "lcd_dma_parallel16.hpp"
+#include "mbi_commands.hpp"
+#include "mbi_frame_encoder.hpp"
+#include "mbi_panel_geometry.hpp"
 #include <array>
 
 #include "sdkconfig.h"
 #include "spi_dma_seg_tx_loop.h"
+#include "TripleBuffer.hpp"
+#include "PixelSink.hpp"
 
 #include <iostream>
 
 class UMatrix : public Matrix {
+  friend class Benchmark;
+
+ public:
+  // Per frame figures, summed over the frames sent to the panel (or found
+  // unchanged) in either mode
+  struct FrameStats {
+    uint32_t frames = 0;        // frames presented
+    uint32_t dropped = 0;       // replaced by a newer one before being encoded
+    uint64_t latency_us = 0;    // update() -> DMA started
+    uint32_t wait_us = 0;       // blocked on the previous frame's DMA
+    uint32_t encoded_rows = 0;  // scan lines encoded
+    uint32_t unchanged = 0;     // identical to the last one, no DMA
+  };
+
  private:
   bool initialized = false;
   // D<A Data to send
   Bus_Parallel16 dma_bus;
 
+  // Greyscale frames are double buffered: one is clocked out by the LCD DMA
+  // while the next one is encoded. dma_grey_gpio_data always points at the
+  // back buffer, which is free for the CPU outside of update().
+  ESP32_GREY_DMA_STORAGE_TYPE* dma_grey_buffers[2];
   ESP32_GREY_DMA_STORAGE_TYPE* dma_grey_gpio_data;
+  uint8_t dma_grey_back = 0;
+  uint32_t frame_wait_us = 0;
+
+  // DMA descriptor chains, built once in init() and re-armed per transfer.
+  // Control sequences have their own buffers (see mbi_build_commands()) and
+  // never touch the greyscale data. Both grey chains carry on into
+  // v_sync_chain, so a frame and the vsync that shows it are one transfer.
+  Bus_Parallel16::dma_chain_t grey_chains[2];
+  Bus_Parallel16::dma_chain_t pre_active_chain;
+  Bus_Parallel16::dma_chain_t v_sync_chain;
+  Bus_Parallel16::dma_chain_t soft_reset_chain;
+  Bus_Parallel16::dma_chain_t config_reg1_chain;
+  Bus_Parallel16::dma_chain_t config_reg2_chain;
 
   size_t dma_grey_buffer_parallel_bit_length;  // Length in bits of the buffer
                                                // -> sequance of 13 x 16 bits (2
@@ -36,20 +74,105 @@ class UMatrix : public Matrix {
                                 // of 13 x 16 bits (2 bytes) sent in parallel =
                                 // value of 26 bytes
 
+  MBI_PanelGeometry geometry;
+
+  // Scan mode as requested, and as currently set up on the panel
+  MBI_ScanMode scan_mode;
+  MBI_ScanMode applied_scan_mode;
+  volatile bool scan_mode_dirty = false;
+  uint16_t grey_mask = PANEL_GREY_MASK_14;
+
+  // RGB888 frame in encoder order, see MBI_FrameEncoder::pixelIndex(). One
+  // extra slot at the end takes writes to pixels that are off the panel.
+  // update() composites the layers into framebuffer, which is
+  // frames[frame_slots.writeSlot()].
+  CRGB* framebuffer;
+
+  // Pipelined mode: update() only hands the finished frame over, the encoder
+  // task on the other core encodes and sends it while the next one is drawn.
+  // frame_stamp is when each slot was handed over, for the latency figures.
+  CRGB* frames[3] = {nullptr, nullptr, nullptr};
+  TripleBuffer frame_slots;
+  int64_t frame_stamp[3] = {0, 0, 0};
+  volatile bool pipelined = false;
+  volatile bool hold_requested = false;  // holdFrame(): present the newest frame again
+  TaskHandle_t encoder_task = nullptr;
+  SemaphoreHandle_t present_lock = nullptr;  // one frame / command at a time on the bus
+
+  // Copy of the last frame sent to the panel, compared per scan line to only
+  // encode what changed. grey_stale_rows tracks, per greyscale buffer, the
+  // scan lines it is still missing (bit n = scan line n).
+  CRGB* shown_frame;
+  uint32_t grey_stale_rows[2];
+  bool frame_force_send = true;
+  uint8_t frame_encoded_rows = 0;
+  FrameStats frame_stats;
+  portMUX_TYPE frame_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+  MBI_FrameEncoder encoder;
+
+  // Brightness as applied to the panel: config register 1 current gain, plus a
+  // software scale (in the colour LUT) for levels below current_gain_min
+  uint8_t applied_brightness = 0;
+  uint8_t current_gain = brightness_base;
+  uint8_t soft_brightness = 255;
+
+  // 8-bit colour -> 16-bit greyscale per channel (R, G, B), rebuilt on change
+  uint16_t colour_lut[3][256];
+  uint8_t white_balance[3] = {255, 255, 255};
+  volatile bool colour_lut_dirty = false;
+
+  // Logical (x, y) -> framebuffer slot for the current rotation / mirroring,
+  // indexed y * geometry.res_x + x. See MBI_FrameEncoder::wordOffset() and
+  // laneShift() for the DMA position a slot stands for.
+  uint16_t* address_map = nullptr;
+  bool mirror_x = false;
+  bool mirror_y = false;
+
+  // Bulk writes into framebuffer with mbi_store_pixel() inlined, the
+  // compositor's output, see PixelSink
+  struct FrameSink : PixelSink<FrameSink> {
+    UMatrix* owner;
+    explicit FrameSink(UMatrix* owner) : owner(owner) {}
+    inline void writePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+      owner->mbi_store_pixel(x, y, r, g, b);
+    }
+  };
+  FrameSink sink{this};
+
   void transform(int16_t &x, int16_t &y, int16_t &w, int16_t &h);
-  void mbi_update_frame(bool configure_latches);
+  void mbi_present(const CRGB* frame, int64_t stamp);
+  bool mbi_encode_frame(const CRGB* frame);
+  void mbi_send_frame();
+  uint32_t mbi_find_changed_rows(const CRGB* frame);
+  static void encoderTask(void* arg);
+  void mbi_invalidate_rows();
+  void mbi_finish_frame();
+  inline void mbi_store_pixel(uint8_t x, uint8_t y, uint8_t r_data,
+                              uint8_t g_data, uint8_t b_data) {
+    if (x >= geometry.res_x || y >= geometry.res_y)
+      return;
+
+    framebuffer[address_map[y * geometry.res_x + x]] = CRGB(r_data, g_data, b_data);
+  }
+  void mbi_update_colour_lut();
+  void mbi_split_brightness();
+  void mbi_apply_brightness();
+  void mbi_apply_scan_mode();
+  void mbi_log_scan_timing();
+  void mbi_build_address_map();
   void mbi_set_pixel(uint8_t x, uint8_t y,  uint8_t _r_data, uint8_t _g_data, uint8_t _b_data);
   void mbi_pre_active_dma();
-  void mbi_v_sync_dma();
   void mbi_soft_reset_dma();
-  void mbi_set_config_dma(unsigned int& dma_output_pos, uint16_t config_reg,
-                          bool latch, bool reg2);
+  void mbi_setup_dma_chains();
+  void mbi_build_commands();
+  void mbi_build_config_reg1();
+  uint16_t mbi_config_reg1_value() const;
   void mbi_send_config_reg1_dma();
   void mbi_send_config_reg2_dma();
   void updateRegisters();
 
  public:
-  UMatrix();
+  explicit UMatrix(const MBI_PanelGeometry& geometry = MBI_PanelGeometry());
 
   void init() override;
 
@@ -60,13 +183,39 @@ class UMatrix : public Matrix {
   uint8_t getBrightness() const override;
   uint8_t getXResolution() override;
   uint8_t getYResolution() override;
+  uint8_t getScanLines() const;
   
   void setRotation(uint8_t newRotation) override;
   void rotate90() override;
+  // Mirror the image left/right and/or flip it upside down, applied before rotation
+  void setMirror(bool horizontal, bool vertical);
+  size_t getAddressMapBytes() const;
+
+  // Switch GCLK multiplier / greyscale depth, applied by the next update().
+  // The high refresh modes trade grey levels for a flicker free camera image.
+  void setScanMode(const MBI_ScanMode& mode);
+  MBI_ScanMode getScanMode() const;
+
+  void setWhiteBalance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain) override;
   void clearScreen() override;
 
   void update() override;
+  void holdFrame() override;
   void refreshMatrixConfig();
 
+  // Run the encoding and DMA on a task on the other core, see frames. Can be
+  // switched at any time, frames in flight are finished first.
+  void setPipelined(bool enabled);
+  bool isPipelined() const { return pipelined; }
+
+  // Totals since the last call, see FrameStats
+  FrameStats takeFrameStats();
+
+  // Time update() spent blocked on the previous frame's DMA transfer
+  uint32_t getFrameWaitUs() const;
+  // Scan lines re-encoded by the last update(), out of getScanLines(). 0 means
+  // nothing changed and no DMA transfer was started.
+  uint8_t getFrameEncodedRows() const;
+
 
 };
\ No newline at end of file
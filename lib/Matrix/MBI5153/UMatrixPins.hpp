@@ -0,0 +1,49 @@
+/******************************************************************************************
+ * @file        UMatrixPins.hpp
+ * @brief       ESP32-S3 GPIO pins of a MBI5135 PWM chip based LED Matrix Panel
+ ******************************************************************************************/
+
+/*
+  Kept apart from UMatrixSettings.hpp so that the encoder, the panel geometry and the
+  emulator, which only need the DMA word layout, build without ESP-IDF.
+*/
+
+#pragma once
+
+#include "hal/gpio_types.h"
+
+// Updated ESP32-S3 Pin GPIO
+/* Experimenting with the ESP32-S3 Dev Module has uncovered that ONLY THESE pins seems to work ok
+ * use other pins at your risk. Don't use 19, 20, 48 etc.
+ * https://api.riot-os.org/group__cpu__esp32__esp32s3.html
+ */
+#define ADDR_A_PIN              GPIO_NUM_17
+#define ADDR_B_PIN              GPIO_NUM_18
+#define ADDR_C_PIN              GPIO_NUM_5
+#define ADDR_D_PIN              GPIO_NUM_6
+#define ADDR_E_PIN              GPIO_NUM_10
+
+#define MBI_GCLK                GPIO_NUM_15  // OE PIN IS GCLK apparently
+#define MBI_LAT                 GPIO_NUM_16  //  data/command
+#define MBI_DCLK                GPIO_NUM_7  // data clocking line?
+#define MBI_SRCLK               GPIO_NUM_48   // I assume SR stands for Scan Row??  // When this is HIGH on these boards, output is disabled?
+
+// First 1/4 of panel -> 20 rows
+#define MBI_G1                  GPIO_NUM_21
+#define MBI_B1                  GPIO_NUM_14 
+#define MBI_R1                  GPIO_NUM_4  
+
+// Second 1/4 of panel -> 20 rows
+#define MBI_G2                  GPIO_NUM_42   
+#define MBI_B2                  GPIO_NUM_41 
+#define MBI_R2                  GPIO_NUM_47  
+
+// Third 1/4 of panel -> 20 rows
+#define MBI_G3                  GPIO_NUM_39  
+#define MBI_B3                  GPIO_NUM_38 
+#define MBI_R3                  GPIO_NUM_40 
+
+// Forth 1/4 of panel -> 20 rows
+#define MBI_G4                  GPIO_NUM_36    
+#define MBI_B4                  GPIO_NUM_35 
+#define MBI_R4                  GPIO_NUM_37
@@ -7,44 +7,8 @@
 
 
 #pragma once
-#include "hal/gpio_types.h"
-
-// Updated ESP32-S3 Pin GPIO
-/* Experimenting with the ESP32-S3 Dev Module has uncovered that ONLY THESE pins seems to work ok
- * use other pins at your risk. Don't use 19, 20, 48 etc.
- * https://api.riot-os.org/group__cpu__esp32__esp32s3.html
- */
-#define ADDR_A_PIN              GPIO_NUM_17
-#define ADDR_B_PIN              GPIO_NUM_18
-#define ADDR_C_PIN              GPIO_NUM_5
-#define ADDR_D_PIN              GPIO_NUM_6
-#define ADDR_E_PIN              GPIO_NUM_10
-
-#define MBI_GCLK                GPIO_NUM_15  // OE PIN IS GCLK apparently
-#define MBI_LAT                 GPIO_NUM_16  //  data/command
-#define MBI_DCLK                GPIO_NUM_7  // data clocking line?
-#define MBI_SRCLK               GPIO_NUM_48   // I assume SR stands for Scan Row??  // When this is HIGH on these boards, output is disabled?
-
-// First 1/4 of panel -> 20 rows
-#define MBI_G1                  GPIO_NUM_21
-#define MBI_B1                  GPIO_NUM_14 
-#define MBI_R1                  GPIO_NUM_4  
-
-// Second 1/4 of panel -> 20 rows
-#define MBI_G2                  GPIO_NUM_42   
-#define MBI_B2                  GPIO_NUM_41 
-#define MBI_R2                  GPIO_NUM_47  
-
-// Third 1/4 of panel -> 20 rows
-#define MBI_G3                  GPIO_NUM_39  
-#define MBI_B3                  GPIO_NUM_38 
-#define MBI_R3                  GPIO_NUM_40 
-
-// Forth 1/4 of panel -> 20 rows
-#define MBI_G4                  GPIO_NUM_36    
-#define MBI_B4                  GPIO_NUM_35 
-#define MBI_R4                  GPIO_NUM_37
 
+// GPIO pins are in UMatrixPins.hpp, only needed by the drivers
 
 // -------------------------------------------------------
 // Internals specific to code and hardware. Do not change.
@@ -89,9 +53,25 @@
 #define PANEL_MBI_LED_CHANS     16  // number of led channels per MBI IC
 #define PANEL_MBI_CHAIN_LEN      5  // number of ic's changed for each subpixel
 
+// Limits for a runtime MBI_PanelGeometry. The scan line count is capped by config
+// register 1 (5 bits) and by the GCLK payload having to fit into one SPI segment.
+#define PANEL_MBI_MAX_SCAN_LINES  32
+#define PANEL_MBI_MAX_CHAIN_LEN   8
+
+// Default geometry, see MBI_PanelGeometry
 #define PANEL_RES_X 78
 #define PANEL_RES_Y 78
 
+// Logical pixel -> framebuffer slot map, rebuilt on rotation / mirror changes.
+// 2 bytes per pixel; uncomment to keep it in PSRAM and save internal RAM.
+// #define PANEL_ADDRESS_MAP_PSRAM 1
+
+// MBI5153 control sequence lengths, in DMA words
+#define MBI_PRE_ACTIVE_LEN      16
+#define MBI_V_SYNC_LEN          600
+#define MBI_SOFT_RESET_LEN      11
+#define MBI_CONFIG_REG_MAX_LEN  (PANEL_MBI_MAX_CHAIN_LEN * 16)
+
 #define PANEL_MBI_RES_X 80
 #define PANEL_MBI_RES_Y 80
 
@@ -99,7 +79,10 @@
 #define ghost_elimination_OFF 0    // послесвечение включено
 #define gray_scale_13         1    // шкала серого 13 бит
 #define gray_scale_14         0    // шкала серого 14 бит
+#define PANEL_GREY_MASK_14    0xFFFC // 14 significant bits, MSB aligned in the 16-bit greyscale word
+#define PANEL_GREY_MASK_13    0xFFF8 // 13 significant bits
 #define brightness_base       63   // varies between 0 and 63
+#define current_gain_min      7    // lowest current gain used for dimming, software scaling below
 /* 
   GCLK multiplier (grayscale clock multiplier)
 
@@ -110,6 +93,13 @@
 
 */
 
+#define gclk_per_row          513  // multiplier OFF
+#define gclk_per_row_multiplied 257  // multiplier ON
+
+// SPI clock of the GCLK / address line loop. One payload byte per clock, so a GCLK
+// (3 bytes) runs at a third of this.
+#define PANEL_GCLK_SPI_HZ   (5 * 1000 * 1000)
+
 #define gclk_multiplier_ON  1  // GCLK Multipler On - You MUST use exactly 257 clocks for each rowscan!
 #define gclk_multiplier_OFF 0  // GCLK Multipler On - You MUST use exactly 513 clocks for each rowscan!
 
@@ -53,6 +53,9 @@ IRAM_ATTR bool gdma_on_trans_eof_callback(gdma_channel_handle_t dma_chan,
 volatile bool buffer_sent = false;
 volatile int trans_done_count = 0;
 
+// Given by lcd_isr once the LCD peripheral has clocked out the last word
+static SemaphoreHandle_t trans_done_sem = NULL;
+
 static void IRAM_ATTR lcd_isr(void* arg) {
 
   // From original Sprite_TM Code
@@ -66,6 +69,11 @@ static void IRAM_ATTR lcd_isr(void* arg) {
   buffer_sent = true;
   trans_done_count++;
 
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  xSemaphoreGiveFromISR(trans_done_sem, &higher_priority_task_woken);
+  if (higher_priority_task_woken) {
+    portYIELD_FROM_ISR();
+  }
 }
 
 
@@ -221,6 +229,9 @@ esp_err_t Bus_Parallel16::setup_lcd_dma_periph(void) {
   // Enable Transaction Done interrupt, useful for us when we send stuff once
   LCD_CAM.lc_dma_int_ena.lcd_trans_done_int_ena = 1;
 
+  trans_done_sem = xSemaphoreCreateBinary();
+  assert(trans_done_sem != NULL);
+
   // Allocate a level 1 intterupt: lowest priority, as ISR isn't urgent and may take a long time to complete
   esp_intr_alloc(ETS_LCD_CAM_INTR_SOURCE, (int)(ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_LEVEL1), lcd_isr, NULL, NULL);
 
@@ -268,65 +279,181 @@ bool Bus_Parallel16::allocate_dma_desc_memory(size_t len) {
   return true;
 }
 
-esp_err_t Bus_Parallel16::dma_transfer_start() {
-  esp_err_t ret = gdma_start(dma_chan, (intptr_t)&_dmadesc_a[0]);  // Start DMA w/updated descriptor(s)
+esp_err_t Bus_Parallel16::dma_transfer_start(HUB75_DMA_DESCRIPTOR_T *head) {
+  if (_tap) {
+    for (HUB75_DMA_DESCRIPTOR_T *desc = head; desc != NULL; desc = desc->next) {
+      _tap(desc->buffer, desc->dw0.length, _tap_arg);
+    }
+    _tap(NULL, 0, _tap_arg);
+  }
+
+  esp_err_t ret = gdma_start(dma_chan, (intptr_t)head);            // Start DMA w/updated descriptor(s)
   esp_rom_delay_us(10);                                            // Must 'bake' a moment before...
 
   buffer_sent = false;
+  _transfer_pending = true;
   LCD_CAM.lcd_user.lcd_start = 1;                                  // Trigger LCD DMA transfer
-  while (LCD_CAM.lcd_user.lcd_start);
-
-  // WAIT UNTIL SENT!
-  while (buffer_sent == false); 
 
   return ret;
 
 }  // end
 
 
+uint32_t Bus_Parallel16::wait_transfer_done() {
+  if (!_transfer_pending) {
+    return 0;
+  }
 
-esp_err_t Bus_Parallel16::send_stuff_once(void *data, size_t size_in_bytes, bool is_greyscale_data) {
+  int64_t wait_start = esp_timer_get_time();
 
-  log_v("Sending DMA payload of length %d bytes.", size_in_bytes);
+  // WAIT UNTIL SENT!
+  xSemaphoreTake(trans_done_sem, portMAX_DELAY);
+  _transfer_pending = false;
 
-  int len = size_in_bytes;
+  return (uint32_t)(esp_timer_get_time() - wait_start);
+}
 
-  int dma_lldesc_required = lldesc_get_required_num(size_in_bytes);
-  log_v("Number of DMA descriptors required for LCD payload is: %d.", dma_lldesc_required);
 
-  // Allocate descriptor block of memory if it hasn't already been allocated
-  allocate_dma_desc_memory(dma_lldesc_required);
+// Fill a linear, EOF terminated descriptor chain for one payload. desc must hold
+// lldesc_get_required_num(size_in_bytes) entries.
+void Bus_Parallel16::dma_desc_fill(HUB75_DMA_DESCRIPTOR_T *desc, void *data, size_t size_in_bytes) {
+  uint8_t *buf = (uint8_t *)data;
+  size_t len = size_in_bytes;
 
   // ripped from soc/lldesc.c
   int n = 0;
   while (len) {
-    int dmachunklen = len;
+    size_t dmachunklen = len;
     if (dmachunklen > LLDESC_MAX_NUM_PER_DESC) {
       dmachunklen = LLDESC_MAX_NUM_PER_DESC;
     }
 
-    _dmadesc_a[n].dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
-    _dmadesc_a[n].dw0.suc_eof = 0;
-    _dmadesc_a[n].dw0.size = _dmadesc_a[n].dw0.length = dmachunklen;
-    _dmadesc_a[n].buffer = (uint8_t *)data;
-    _dmadesc_a[n].next = (dma_descriptor_t *)&_dmadesc_a[n + 1];
+    desc[n].dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+    desc[n].dw0.suc_eof = 0;
+    desc[n].dw0.size = desc[n].dw0.length = dmachunklen;
+    desc[n].buffer = buf;
+    desc[n].next = &desc[n + 1];
 
     len -= dmachunklen;
-    data += dmachunklen;
-
-    log_v("Configured _dmadesc_a at pos %d, memory location %08x, pointing to data of size %d. Next dma desc is %d.", n, (uintptr_t)&_dmadesc_a[n], (int)_dmadesc_a[n].dw0.size, n + 1);
+    buf += dmachunklen;
     n++;
   }
 
-  log_v("Configured _dmadesc_a at pos %d, to have EOF flag = 1.", n - 1);
-
   // All done, no looping here this time!
-  _dmadesc_a[n - 1].dw0.suc_eof = 1;  //Mark last DMA desc as end of stream.
-  _dmadesc_a[n - 1].next = NULL;      // no next item
-  //_dmadesc_a[n-1].next        = (dma_descriptor_t *) &_dmadesc_a[0]; // loop forever
+  desc[n - 1].dw0.suc_eof = 1;  //Mark last DMA desc as end of stream.
+  desc[n - 1].next = NULL;      // no next item
+}
+
+
+esp_err_t Bus_Parallel16::dma_desc_setup(void *data, size_t size_in_bytes) {
+
+  log_v("Sending DMA payload of length %d bytes.", size_in_bytes);
+
+  int dma_lldesc_required = lldesc_get_required_num(size_in_bytes);
+  log_v("Number of DMA descriptors required for LCD payload is: %d.", dma_lldesc_required);
+
+  // Allocate descriptor block of memory if it hasn't already been allocated
+  if (!allocate_dma_desc_memory(dma_lldesc_required)) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  dma_desc_fill(_dmadesc_a, data, size_in_bytes);
+
+  return ESP_OK;
+}
+
+
+esp_err_t Bus_Parallel16::send_stuff_once(void *data, size_t size_in_bytes, bool is_greyscale_data) {
+
+  // Descriptors are shared, let any asynchronous transfer finish first
+  wait_transfer_done();
+
+  esp_err_t ret = dma_desc_setup(data, size_in_bytes);
+  if (ret != ESP_OK) {
+    return ret;
+  }
 
   // Send it!
-  return dma_transfer_start();
+  ret = dma_transfer_start(_dmadesc_a);
+  wait_transfer_done();
+
+  return ret;
+}
+
+
+esp_err_t Bus_Parallel16::send_stuff_async(void *data, size_t size_in_bytes) {
+
+  wait_transfer_done();
+
+  esp_err_t ret = dma_desc_setup(data, size_in_bytes);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  return dma_transfer_start(_dmadesc_a);
+}
+
+
+bool Bus_Parallel16::create_dma_chain(dma_chain_t &chain, void *data, size_t size_in_bytes) {
+  release_dma_chain(chain);
+
+  uint32_t required = lldesc_get_required_num(size_in_bytes);
+
+  log_d("Allocating %d bytes memory for a %d byte DMA chain.", (int)(sizeof(HUB75_DMA_DESCRIPTOR_T) * required), (int)size_in_bytes);
+  chain.desc = (HUB75_DMA_DESCRIPTOR_T *)heap_caps_malloc(sizeof(HUB75_DMA_DESCRIPTOR_T) * required, MALLOC_CAP_DMA);
+
+  if (chain.desc == nullptr) {
+    log_e("ERROR: Couldn't malloc DMA chain descriptors. Not enough memory.");
+    return false;
+  }
+
+  dma_desc_fill(chain.desc, data, size_in_bytes);
+  chain.desc_count = required;
+  chain.size_in_bytes = size_in_bytes;
+
+  return true;
+}
+
+
+void Bus_Parallel16::release_dma_chain(dma_chain_t &chain) {
+  if (chain.desc) {
+    wait_transfer_done();  // could be the one in flight
+    heap_caps_free(chain.desc);
+  }
+  chain = dma_chain_t();
+}
+
+
+esp_err_t Bus_Parallel16::send_chain_once(const dma_chain_t &chain) {
+  esp_err_t ret = send_chain_async(chain);
+  wait_transfer_done();
+
+  return ret;
+}
+
+
+void Bus_Parallel16::append_dma_chain(dma_chain_t &chain, const dma_chain_t &tail) {
+  if (chain.desc == nullptr || tail.desc == nullptr) {
+    return;
+  }
+
+  HUB75_DMA_DESCRIPTOR_T *last = &chain.desc[chain.desc_count - 1];
+  last->dw0.suc_eof = 0;  // EOF moves to the end of tail
+  last->next = tail.desc;
+  chain.size_in_bytes += tail.size_in_bytes;
+}
+
+
+// The GDMA doesn't write the descriptors back (owner_check / auto_update_desc
+// are off), so a chain can be restarted as is.
+esp_err_t Bus_Parallel16::send_chain_async(const dma_chain_t &chain) {
+  if (chain.desc == nullptr) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  wait_transfer_done();
+
+  return dma_transfer_start(chain.desc);
 }
 
 
@@ -64,6 +64,10 @@
 
 #include <esp_heap_caps.h>
 #include <esp_heap_caps_init.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 
 #if __has_include (<esp_private/periph_ctrl.h>)
@@ -123,19 +127,59 @@
       };
     };
 
+    // A descriptor chain built once over a fixed payload (pointer + length) and
+    // re-armed for every transfer. The payload content may change between
+    // transfers, its location and size may not.
+    struct dma_chain_t
+    {
+      HUB75_DMA_DESCRIPTOR_T* desc = nullptr;
+      uint32_t desc_count = 0;
+      size_t   size_in_bytes = 0;
+    };
+
+    // Called with every buffer of a transfer as it is started, then once more
+    // with data == nullptr. For checking the output against a panel model
+    // (see MBI_Emulator), costs nothing while unset.
+    typedef void (*transfer_tap_t)(const void *data, size_t size_in_bytes, void *arg);
+
     const config_t& config(void) const { return _cfg; }
     void  config(const config_t& config);
     
     esp_err_t setup_lcd_dma_periph(void) ;       
     esp_err_t send_stuff_once(void *data, size_t size_in_bytes, bool is_greyscale_data = false);
 
+    // Start sending and return straight away, the buffer must stay untouched
+    // until wait_transfer_done() returns.
+    esp_err_t send_stuff_async(void *data, size_t size_in_bytes);
+
+    // Block until the transfer in flight (if any) has left the LCD peripheral.
+    // Returns how long we actually had to wait, in microseconds.
+    uint32_t  wait_transfer_done();
+    bool      is_transfer_pending() const { return _transfer_pending; }
+
+    // Prebuilt descriptor chains, see dma_chain_t. Build them at init, the
+    // send functions then only have to start the DMA.
+    bool      create_dma_chain(dma_chain_t &chain, void *data, size_t size_in_bytes);
+    void      release_dma_chain(dma_chain_t &chain);
+    esp_err_t send_chain_once(const dma_chain_t &chain);
+    esp_err_t send_chain_async(const dma_chain_t &chain);
+
+    // Carry on with tail at the end of chain instead of ending the transfer,
+    // so both go out in one. tail's descriptors are linked, not copied, and
+    // may end any number of chains.
+    void      append_dma_chain(dma_chain_t &chain, const dma_chain_t &tail);
+
     int get_transfer_count();
 
+    void set_transfer_tap(transfer_tap_t tap, void *arg) { _tap = tap; _tap_arg = arg; }
+
   protected:
 
     esp_err_t release(void) ;
     bool      allocate_dma_desc_memory (size_t len);
-    esp_err_t dma_transfer_start();
+    esp_err_t dma_transfer_start(HUB75_DMA_DESCRIPTOR_T *head);
+    esp_err_t dma_desc_setup(void *data, size_t size_in_bytes);
+    static void dma_desc_fill(HUB75_DMA_DESCRIPTOR_T *desc, void *data, size_t size_in_bytes);
 
      
   private:
@@ -150,6 +194,11 @@
 
     HUB75_DMA_DESCRIPTOR_T* _dmadesc_a = nullptr;
 
+    volatile bool _transfer_pending = false;
+
+    transfer_tap_t _tap = nullptr;
+    void*          _tap_arg = nullptr;
+
     esp_lcd_i80_bus_handle_t _i80_bus;
 
 
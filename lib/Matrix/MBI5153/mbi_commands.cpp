@@ -0,0 +1,63 @@
+#include "mbi_commands.hpp"
+
+#include <string.h>
+
+void MBI_Commands::preActive(ESP32_GREY_DMA_STORAGE_TYPE* dst) {
+  int pos = 0;
+  for (int i = 0; i < MBI_LAT_PRE_ACTIVE; i++) {
+    dst[pos++] = BIT_LAT;
+  }
+  while (pos < MBI_PRE_ACTIVE_LEN) {
+    dst[pos++] = 0x00;
+  }
+}
+
+void MBI_Commands::vSync(ESP32_GREY_DMA_STORAGE_TYPE* dst) {
+  memset(dst, 0, MBI_V_SYNC_LEN * sizeof(ESP32_GREY_DMA_STORAGE_TYPE));
+  int pos = MBI_V_SYNC_LEN - (MBI_V_SYNC_LEN / 2);
+  for (int i = 0; i < MBI_LAT_V_SYNC; i++) {
+    dst[pos++] = BIT_LAT;
+  }
+}
+
+void MBI_Commands::softReset(ESP32_GREY_DMA_STORAGE_TYPE* dst) {
+  int pos = 0;
+  for (int i = 0; i < MBI_LAT_SOFT_RESET; i++) {
+    dst[pos++] = BIT_LAT;
+  }
+  while (pos < MBI_SOFT_RESET_LEN) {
+    dst[pos++] = 0x00;
+  }
+}
+
+// LAT goes high for the last 4 (register 1) or 8 (register 2) bits sent to
+// the last IC
+void MBI_Commands::config(ESP32_GREY_DMA_STORAGE_TYPE* dst,
+                          const MBI_PanelGeometry& geometry, uint16_t value,
+                          bool reg2) {
+  int latch_trigger_point = reg2 ? MBI_LAT_WRITE_CONFIG2 : MBI_LAT_WRITE_CONFIG1;
+  int pos = 0;
+
+  for (int ic = 0; ic < geometry.chain_len; ic++) {
+    bool latch = ic == geometry.chain_len - 1;
+    for (int bit = 15; bit >= 0; bit--) {
+      uint16_t word = ((value >> bit) & 1) ? BIT_ALL_RGB : 0;
+      if (latch && bit < latch_trigger_point) {
+        word |= BIT_LAT;
+      }
+      dst[pos++] = word;
+    }
+  }
+}
+
+uint16_t MBI_Commands::configReg1(const MBI_PanelGeometry& geometry,
+                                  const MBI_ScanMode& mode,
+                                  uint8_t current_gain) {
+  int ghost_elimination = ghost_elimination_ON;
+  int line_num = geometry.scan_lines - 1;
+  int gray_scale = mode.grey_13bit ? gray_scale_13 : gray_scale_14;
+  int gclk_multiplier = mode.gclk_multiplier ? gclk_multiplier_ON : gclk_multiplier_OFF;
+
+  return (ghost_elimination << 14) | (line_num << 8) | (gray_scale << 7) |
+         (gclk_multiplier << 6) | current_gain;
+}
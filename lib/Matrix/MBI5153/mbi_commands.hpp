@@ -0,0 +1,60 @@
+/******************************************************************************************
+ * @file        mbi_commands.hpp
+ * @brief       MBI5153 control sequences as parallel words for the LCD DMA
+ ******************************************************************************************/
+
+/*
+  The MBI5153 tells its commands apart by how many DCLKs LAT stays high for. Every
+  sequence here is a run of 16-bit words in the same layout as the greyscale buffer
+  (see UMatrixSettings.hpp for the bits), ready to be clocked out by the LCD peripheral.
+  Only the chain length and the register values go into them, so UMatrix builds them
+  once into their own DMA buffers.
+
+  No ESP-IDF dependencies, so the exact words UMatrix sends can be played through
+  MBI_Emulator on a host.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "UMatrixSettings.hpp"
+#include "mbi_panel_geometry.hpp"
+
+// LAT clocks of each MBI5153 command
+#define MBI_LAT_DATA_LATCH      1
+#define MBI_LAT_V_SYNC          3
+#define MBI_LAT_WRITE_CONFIG1   4
+#define MBI_LAT_WRITE_CONFIG2   8
+#define MBI_LAT_SOFT_RESET      10
+#define MBI_LAT_PRE_ACTIVE      14
+
+// Config register 2, with the setting that reduces ghosting
+#define MBI_CONFIG_REG2_VALUE   0b1001000000011110
+
+class MBI_Commands {
+ public:
+  // MBI_PRE_ACTIVE_LEN words, enables the next config register write
+  static void preActive(ESP32_GREY_DMA_STORAGE_TYPE* dst);
+
+  // MBI_V_SYNC_LEN words, the vsync half way through a blank run. Shows the
+  // greyscale data latched since the last one.
+  static void vSync(ESP32_GREY_DMA_STORAGE_TYPE* dst);
+
+  // MBI_SOFT_RESET_LEN words
+  static void softReset(ESP32_GREY_DMA_STORAGE_TYPE* dst);
+
+  // A config register value shifted through the whole chain and latched by the
+  // last IC, so every IC ends up with it. configWords() words.
+  static void config(ESP32_GREY_DMA_STORAGE_TYPE* dst,
+                     const MBI_PanelGeometry& geometry, uint16_t value,
+                     bool reg2);
+  static size_t configWords(const MBI_PanelGeometry& geometry) {
+    return geometry.chain_len * 16;
+  }
+
+  // Config register 1 for the panel, scan mode and current gain (0 - 63)
+  static uint16_t configReg1(const MBI_PanelGeometry& geometry,
+                             const MBI_ScanMode& mode, uint8_t current_gain);
+};
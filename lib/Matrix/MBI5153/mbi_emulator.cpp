@@ -0,0 +1,231 @@
+#include "mbi_emulator.hpp"
+
+#include <string.h>
+
+// GCLK / address line payload bits, see spi_dma_seg_tx_payload.h
+#define GCLK_PAYLOAD_GCLK       0x80
+#define GCLK_PAYLOAD_ADDR_SHIFT 2
+#define GCLK_PAYLOAD_ADDR_MASK  0x1F
+
+// Data line of a colour channel within its lane (G, B, R on consecutive bits)
+static const int channel_line[3] = {2, 0, 1};
+
+MBI_Emulator::MBI_Emulator(const MBI_PanelGeometry& geometry)
+    : geometry(geometry) {
+  reset();
+}
+
+void MBI_Emulator::reset() {
+  const size_t lines = PANEL_MBI_LANES * 3;
+  shift.assign(lines * geometry.chain_len, 0);
+  sram.assign(lines * geometry.scan_lines * PANEL_MBI_LED_CHANS * geometry.chain_len, 0);
+  shown.assign(sram.size(), 0);
+
+  stats = Stats();
+  lat_clocks = 0;
+  latched = 0;
+  config_enabled = false;
+  config_consistent = true;
+  config_reg[0] = config_reg[1] = 0;
+}
+
+void MBI_Emulator::clockWords(const uint16_t* words, size_t count) {
+  stats.words += count;
+
+  for (size_t i = 0; i < count; i++) {
+    uint16_t word = words[i];
+
+    // A command runs when LAT falls, after counting the DCLKs it was high for
+    if (!(word & BIT_LAT) && lat_clocks) {
+      command(lat_clocks);
+      lat_clocks = 0;
+    }
+
+    shiftIn(word);
+
+    if (word & BIT_LAT) {
+      lat_clocks++;
+    }
+  }
+}
+
+void MBI_Emulator::endTransfer() {
+  stats.transfers++;
+  if (lat_clocks) {
+    command(lat_clocks);
+    lat_clocks = 0;
+  }
+}
+
+void MBI_Emulator::busTap(const void* data, size_t size_in_bytes, void* arg) {
+  MBI_Emulator* emulator = (MBI_Emulator*)arg;
+  if (data == nullptr) {
+    emulator->endTransfer();
+    return;
+  }
+  emulator->clockWords((const uint16_t*)data, size_in_bytes / sizeof(uint16_t));
+}
+
+// Every data line is one long shift register through the chain, the bit
+// leaving the top of an IC's register enters the next IC.
+void MBI_Emulator::shiftIn(uint16_t word) {
+  for (int line = 0; line < PANEL_MBI_LANES * 3; line++) {
+    uint16_t* reg = &shift[regIndex(line, 0)];
+    for (int ic = geometry.chain_len - 1; ic > 0; ic--) {
+      reg[ic] = (reg[ic] << 1) | (reg[ic - 1] >> 15);
+    }
+    reg[0] = (reg[0] << 1) | ((word >> line) & 1);
+  }
+}
+
+void MBI_Emulator::command(int clocks) {
+  switch (clocks) {
+    case MBI_LAT_DATA_LATCH:
+      dataLatch();
+      break;
+
+    case 2:
+    case MBI_LAT_V_SYNC:
+      // A frame is either complete or not started, the chips would show a
+      // mix of old and new scan lines otherwise.
+      if (latched != 0 && latched != geometry.scan_lines * PANEL_MBI_LED_CHANS) {
+        stats.errors++;
+      }
+      shown = sram;
+      latched = 0;
+      stats.v_syncs++;
+      break;
+
+    case MBI_LAT_WRITE_CONFIG1:
+      writeConfig(0);
+      break;
+
+    case MBI_LAT_WRITE_CONFIG2:
+      writeConfig(1);
+      break;
+
+    case MBI_LAT_SOFT_RESET:
+      latched = 0;
+      config_enabled = false;
+      stats.soft_resets++;
+      break;
+
+    case MBI_LAT_PRE_ACTIVE:
+      config_enabled = true;
+      break;
+
+    default:
+      stats.errors++;
+      break;
+  }
+}
+
+// The 16 bits in each IC go to the next channel of the current scan line
+void MBI_Emulator::dataLatch() {
+  if (latched >= geometry.scan_lines * PANEL_MBI_LED_CHANS) {
+    stats.errors++;  // more data than scan lines, no vsync in between
+    return;
+  }
+
+  int row = latched / PANEL_MBI_LED_CHANS;
+  int chan = latched % PANEL_MBI_LED_CHANS;
+  for (int line = 0; line < PANEL_MBI_LANES * 3; line++) {
+    for (int ic = 0; ic < geometry.chain_len; ic++) {
+      sram[sramIndex(line, row, chan, ic)] = shift[regIndex(line, ic)];
+    }
+  }
+
+  latched++;
+  stats.data_latches++;
+}
+
+// Config registers are shifted in on every data line. Each IC takes its own
+// copy, so all of them have to match to configure the panel as one.
+void MBI_Emulator::writeConfig(int reg) {
+  if (!config_enabled) {
+    stats.errors++;  // ignored without a pre-active command first
+    return;
+  }
+  config_enabled = false;
+
+  uint16_t value = shift[regIndex(0, 0)];
+  config_consistent = true;
+  for (size_t i = 0; i < shift.size(); i++) {
+    if (shift[i] != value) {
+      config_consistent = false;
+    }
+  }
+  if (!config_consistent) {
+    stats.errors++;
+  }
+
+  config_reg[reg] = value;
+  stats.config_writes++;
+}
+
+uint16_t MBI_Emulator::shownGrey(uint16_t x, uint16_t y, int channel) const {
+  if (x >= geometry.mbiResX() || y >= geometry.mbiResY() || channel < 0 || channel > 2) {
+    return 0;
+  }
+
+  // The first IC's worth of data ends up at the far end of the chain, which
+  // drives the first 16 columns
+  int ic = geometry.chain_len - 1 - x / PANEL_MBI_LED_CHANS;
+  int chan = x % PANEL_MBI_LED_CHANS;
+  int lane = y / geometry.scan_lines;
+  int row = y % geometry.scan_lines;
+  int line = lane * 3 + channel_line[channel];
+
+  bool grey_13bit = (config_reg[0] >> 7) & 1;
+  uint16_t mask = grey_13bit ? PANEL_GREY_MASK_13 : PANEL_GREY_MASK_14;
+
+  return shown[sramIndex(line, row, chan, ic)] & mask;
+}
+
+bool MBI_Emulator::checkGclkPayload(const uint8_t* payload, size_t size,
+                                    int gclks_per_row) {
+  if (payload == nullptr || size == 0) {
+    stats.errors++;
+    return false;
+  }
+
+  // The loop repeats, so the level before the first byte is that of the last
+  bool gclk = payload[size - 1] & GCLK_PAYLOAD_GCLK;
+  int expected_row = 0;
+  int row = -1;
+  int pulses = 0;
+  bool ok = true;
+
+  for (size_t i = 0; i <= size; i++) {
+    int addr = (i < size) ? (payload[i] >> GCLK_PAYLOAD_ADDR_SHIFT) & GCLK_PAYLOAD_ADDR_MASK : -1;
+
+    if (addr != row) {
+      if (row >= 0) {
+        // scan line finished
+        if (row != expected_row || pulses != gclks_per_row) {
+          ok = false;
+        }
+        expected_row++;
+      }
+      row = addr;
+      pulses = 0;
+    }
+    if (i == size) {
+      break;
+    }
+
+    bool level = payload[i] & GCLK_PAYLOAD_GCLK;
+    if (level && !gclk) {
+      pulses++;
+    }
+    gclk = level;
+  }
+
+  if (expected_row != geometry.scan_lines) {
+    ok = false;
+  }
+  if (!ok) {
+    stats.errors++;
+  }
+  return ok;
+}
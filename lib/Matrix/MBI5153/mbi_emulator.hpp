@@ -0,0 +1,103 @@
+/******************************************************************************************
+ * @file        mbi_emulator.hpp
+ * @brief       Software model of a chain of MBI5153s, decoding DMA output back to pixels
+ ******************************************************************************************/
+
+/*
+  Takes the 16-bit parallel words exactly as the LCD peripheral clocks them out (one DCLK
+  per word) and plays them through a model of the panel: one shift register per RGB data
+  line running through the whole chain, LAT pulses decoded by their length into data
+  latch, vsync, config register writes and soft reset, greyscale SRAM filled line by line
+  and swapped to the LEDs on vsync. The greyscale shown by every LED can then be read
+  back by panel coordinate and compared against what was drawn.
+
+  The GCLK / address line loop is checked separately, from its payload bytes.
+
+  No ESP-IDF dependencies: the model builds on a host together with mbi_frame_encoder,
+  and on the device it can be attached to Bus_Parallel16 with set_transfer_tap().
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "mbi_commands.hpp"
+#include "mbi_panel_geometry.hpp"
+
+class MBI_Emulator {
+ public:
+  struct Stats {
+    uint32_t transfers = 0;
+    uint32_t words = 0;
+    uint32_t data_latches = 0;
+    uint32_t v_syncs = 0;
+    uint32_t config_writes = 0;
+    uint32_t soft_resets = 0;
+    uint32_t errors = 0;  // anything the real chips would not accept
+  };
+
+  explicit MBI_Emulator(const MBI_PanelGeometry& geometry = MBI_PanelGeometry());
+
+  // Power on state: blank SRAM and LEDs, registers unknown
+  void reset();
+
+  // Words clocked out by the LCD peripheral, in order. A LAT pulse still high
+  // at the end of the words carries on into the next call.
+  void clockWords(const uint16_t* words, size_t count);
+
+  // The bus went idle, LAT is low again
+  void endTransfer();
+
+  // Signature of Bus_Parallel16::transfer_tap_t, arg is the emulator
+  static void busTap(const void* data, size_t size_in_bytes, void* arg);
+
+  // Greyscale on the LEDs at an MBI coordinate (panel offsets included, not
+  // rotated), channel 0 = R, 1 = G, 2 = B. Masked to the greyscale depth set in
+  // config register 1, as the PWM only uses those bits.
+  uint16_t shownGrey(uint16_t x, uint16_t y, int channel) const;
+
+  // Last value written to a config register, and whether every IC in the
+  // chain got the same value
+  uint16_t configReg1() const { return config_reg[0]; }
+  uint16_t configReg2() const { return config_reg[1]; }
+  bool configConsistent() const { return config_consistent; }
+
+  // Check a GCLK / address line payload as sent by the SPI loop: every scan line
+  // in order with exactly gclks_per_row GCLK pulses. Returns false and counts
+  // an error otherwise.
+  bool checkGclkPayload(const uint8_t* payload, size_t size, int gclks_per_row);
+
+  const Stats& getStats() const { return stats; }
+  const MBI_PanelGeometry& getGeometry() const { return geometry; }
+
+ private:
+  void shiftIn(uint16_t word);
+  void command(int lat_clocks);
+  void dataLatch();
+  void writeConfig(int reg);
+
+  // Index of one IC's 16-bit value on a data line (line = lane * 3 + G/B/R)
+  inline size_t regIndex(int line, int ic) const {
+    return line * geometry.chain_len + ic;
+  }
+  inline size_t sramIndex(int line, int row, int chan, int ic) const {
+    return ((line * geometry.scan_lines + row) * PANEL_MBI_LED_CHANS + chan) *
+               geometry.chain_len + ic;
+  }
+
+  MBI_PanelGeometry geometry;
+  Stats stats;
+
+  std::vector<uint16_t> shift;  // [line][ic], ic 0 is next to the data input
+  std::vector<uint16_t> sram;   // [line][row][chan][ic], being written
+  std::vector<uint16_t> shown;  // same, on the LEDs since the last vsync
+
+  int lat_clocks = 0;
+  int latched = 0;  // data latches since the last vsync
+  bool config_enabled = false;
+  bool config_consistent = true;
+  uint16_t config_reg[2] = {0, 0};
+};
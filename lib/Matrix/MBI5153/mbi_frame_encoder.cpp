@@ -0,0 +1,158 @@
+#include "mbi_frame_encoder.hpp"
+
+#include <string.h>
+
+#if __has_include(<esp_attr.h>)
+#include <esp_attr.h>
+#else
+#define DRAM_ATTR
+#endif
+
+// Bit-plane spread table. For a greyscale byte v, spread[v][n] holds the two DMA words
+// 2n and 2n+1 as the low / high half of a 32-bit value, each half being bit (7-2n) and
+// bit (6-2n) of v respectively (MSB first). Shifting by the GPIO bit of a colour lane
+// and OR-ing accumulates the whole transposed word pair with one lookup.
+DRAM_ATTR static uint32_t spread[256][4];
+static bool spread_ready = false;
+
+static void build_spread_table() {
+  for (int v = 0; v < 256; v++) {
+    for (int n = 0; n < 4; n++) {
+      uint32_t lo = (v >> (7 - 2 * n)) & 1;
+      uint32_t hi = (v >> (6 - 2 * n)) & 1;
+      spread[v][n] = lo | (hi << 16);
+    }
+  }
+  spread_ready = true;
+}
+
+MBI_FrameEncoder::MBI_FrameEncoder(const MBI_PanelGeometry& geometry)
+    : geometry(geometry) {
+  if (!spread_ready) {
+    build_spread_table();
+  }
+  for (int c = 0; c < 3; c++) {
+    for (int i = 0; i < 256; i++) {
+      colour_lut[c][i] = i << 8;
+    }
+  }
+}
+
+void MBI_FrameEncoder::setColourLut(const uint16_t* r_lut, const uint16_t* g_lut,
+                                    const uint16_t* b_lut) {
+  memcpy(colour_lut[0], r_lut, sizeof(colour_lut[0]));
+  memcpy(colour_lut[1], g_lut, sizeof(colour_lut[1]));
+  memcpy(colour_lut[2], b_lut, sizeof(colour_lut[2]));
+}
+
+// High byte of the 16-bit greyscale value goes to words 0..7, low byte to 8..15
+#define ENCODE_CHANNEL(channel, value, bit)                     \
+  {                                                             \
+    uint16_t grey = colour_lut[channel][value];                 \
+    const uint32_t* s = spread[grey >> 8];                      \
+    const uint32_t* t = spread[grey & 0xff];                    \
+    w01 |= s[0] << (bit);                                       \
+    w23 |= s[1] << (bit);                                       \
+    w45 |= s[2] << (bit);                                       \
+    w67 |= s[3] << (bit);                                       \
+    w89 |= t[0] << (bit);                                       \
+    wAB |= t[1] << (bit);                                       \
+    wCD |= t[2] << (bit);                                       \
+    wEF |= t[3] << (bit);                                       \
+  }
+
+#define ENCODE_LANE(lane)                                          \
+  ENCODE_CHANNEL(1, rgb[(lane) * 3 + 1], (lane) * 3 + 0) /* G */ \
+  ENCODE_CHANNEL(2, rgb[(lane) * 3 + 2], (lane) * 3 + 1) /* B */ \
+  ENCODE_CHANNEL(0, rgb[(lane) * 3 + 0], (lane) * 3 + 2) /* R */
+
+void MBI_FrameEncoder::encode(const uint8_t* rgb,
+                              ESP32_GREY_DMA_STORAGE_TYPE* out) const {
+  encodeRows(rgb, out, geometry.allRows());
+}
+
+void MBI_FrameEncoder::encodeRows(const uint8_t* rgb,
+                                  ESP32_GREY_DMA_STORAGE_TYPE* out,
+                                  uint32_t rows) const {
+  for (int row = 0; row < geometry.scan_lines; row++) {
+    if (!(rows & (1UL << row))) {
+      continue;
+    }
+    encodeRow(rgb + row * rowSlots() * 3, out + row * rowWords());
+  }
+}
+
+void MBI_FrameEncoder::encodeRow(const uint8_t* rgb,
+                                 ESP32_GREY_DMA_STORAGE_TYPE* out) const {
+  uint32_t* dst = (uint32_t*)out;
+
+  for (int chan = 0; chan < PANEL_MBI_LED_CHANS; chan++) {
+    for (int ic = 0; ic < geometry.chain_len; ic++) {
+      uint32_t w01 = 0, w23 = 0, w45 = 0, w67 = 0;
+      uint32_t w89 = 0, wAB = 0, wCD = 0, wEF = 0;
+
+      ENCODE_LANE(0);
+      ENCODE_LANE(1);
+      ENCODE_LANE(2);
+      ENCODE_LANE(3);
+      rgb += PANEL_MBI_LANES * 3;
+
+      dst[0] = w01;
+      dst[1] = w23;
+      dst[2] = w45;
+      dst[3] = w67;
+      dst[4] = w89;
+      dst[5] = wAB;
+      dst[6] = wCD;
+      // data latch on the last bit of the last chained IC, that bit is
+      // always blank in 14-bit greyscale mode
+      dst[7] = wEF | ((ic == geometry.chain_len - 1) ? ((uint32_t)BIT_LAT << 16) : 0);
+      dst += PANEL_MBI_GREY_BITS / 2;
+    }
+  }
+}
+
+void MBI_FrameEncoder::rotate(int16_t& x, int16_t& y, uint8_t rotation) const {
+  int16_t temp;
+  switch (rotation) {
+    case 1:  // 90 degrees clockwise
+      temp = x;
+      x = y;
+      y = geometry.res_x - 1 - temp;
+      break;
+    case 2:  // 180 degrees
+      x = geometry.res_x - 1 - x;
+      y = geometry.res_y - 1 - y;
+      break;
+    case 3:  // 270 degrees clockwise
+      temp = x;
+      x = geometry.res_y - 1 - y;
+      y = temp;
+      break;
+    default:  // No rotation
+      break;
+  }
+}
+
+// Rotation, mirroring, the panel offset and the MBI5153 channel / chain / lane
+// layout, resolved once per orientation instead of once per pixel
+void MBI_FrameEncoder::buildAddressMap(uint16_t* map, uint8_t rotation,
+                                       bool mirror_x, bool mirror_y) const {
+  for (int16_t y = 0; y < geometry.res_y; y++) {
+    for (int16_t x = 0; x < geometry.res_x; x++) {
+      int16_t _x = mirror_x ? geometry.res_x - 1 - x : x;
+      int16_t _y = mirror_y ? geometry.res_y - 1 - y : y;
+      rotate(_x, _y, rotation);
+
+      uint16_t& slot = map[y * geometry.res_x + x];
+
+      if (_x < 0 || _y < 0 || _x >= geometry.res_x || _y >= geometry.res_y) {
+        slot = pixelCount();
+        continue;
+      }
+
+      // offset for missing pixels on the left / top
+      slot = pixelIndex(_x + geometry.offset_x, _y + geometry.offset_y);
+    }
+  }
+}
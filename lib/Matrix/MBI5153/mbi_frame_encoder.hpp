@@ -0,0 +1,88 @@
+/******************************************************************************************
+ * @file        mbi_frame_encoder.hpp
+ * @brief       Frame-level greyscale encoder for MBI5153 based LED Matrix Panels
+ ******************************************************************************************/
+
+/*
+  The MBI5153 greyscale buffer is a stream of 16-bit parallel words. Every word carries
+  one greyscale bit for each of the 12 RGB data lines (4 quarter-panel lanes x RGB),
+  so a single pixel is spread across 16 consecutive words, MSB first.
+
+  Rather than OR-ing pixels into that buffer one bit at a time, the encoder works on a
+  finished RGB888 framebuffer that is stored in "encoder order": the 4 lanes that share
+  the same 16 DMA words sit next to each other. Encoding is then a straight walk over the
+  framebuffer that transposes 12 colour bytes into 16 words with table lookups, writing
+  each DMA word exactly once. Each colour byte first goes through a per channel LUT to
+  its 16-bit greyscale value, so gamma, white balance and brightness cost nothing here.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "UMatrixSettings.hpp"
+#include "mbi_panel_geometry.hpp"
+
+class MBI_FrameEncoder {
+ public:
+  explicit MBI_FrameEncoder(const MBI_PanelGeometry& geometry = MBI_PanelGeometry());
+
+  const MBI_PanelGeometry& getGeometry() const { return geometry; }
+
+  // Framebuffer slot for a physical (post rotation / offset) panel coordinate.
+  inline size_t pixelIndex(uint16_t x, uint16_t y) const {
+    size_t group = ((y % geometry.scan_lines) * PANEL_MBI_LED_CHANS +
+                    (x % PANEL_MBI_LED_CHANS)) * geometry.chain_len +
+                   (x / PANEL_MBI_LED_CHANS);
+    return group * PANEL_MBI_LANES + (y / geometry.scan_lines);
+  }
+
+  // Where a framebuffer slot lands in the greyscale DMA buffer: the first of its
+  // 16 words, and the GPIO shift of its quarter-panel lane within each word.
+  static inline size_t wordOffset(size_t slot) {
+    return (slot / PANEL_MBI_LANES) * PANEL_MBI_GREY_BITS;
+  }
+  static inline uint8_t laneShift(size_t slot) {
+    return (slot % PANEL_MBI_LANES) * 3;
+  }
+
+  // Logical coordinate -> physical one (offsets not included yet) for a
+  // rotation in quarter turns clockwise. A quarter turn of a non-square panel
+  // pushes some pixels off it.
+  void rotate(int16_t& x, int16_t& y, uint8_t rotation) const;
+
+  // Logical (x, y) -> framebuffer slot for the given rotation and mirroring
+  // (mirrored first), res_x * res_y entries indexed y * res_x + x. Pixels off
+  // the panel get pixelCount(), a spare slot after the framebuffer.
+  void buildAddressMap(uint16_t* map, uint8_t rotation, bool mirror_x,
+                       bool mirror_y) const;
+
+  // Number of framebuffer slots (RGB888 triplets) the encoder reads.
+  size_t pixelCount() const { return geometry.pixelCount(); }
+
+  // Framebuffer slots and DMA words per scan line. Both the framebuffer and the
+  // greyscale buffer hold the scan lines back to back, in scan order.
+  size_t rowSlots() const { return geometry.rowSlots(); }
+  size_t rowWords() const { return geometry.rowWords(); }
+
+  // 256 entry lookups from an 8-bit colour channel to the 16-bit greyscale
+  // value sent to the MBI5153 (MSB aligned, 14 significant bits in 14-bit mode)
+  void setColourLut(const uint16_t* r_lut, const uint16_t* g_lut,
+                    const uint16_t* b_lut);
+
+  // Encode a whole RGB888 framebuffer (pixelCount() triplets, encoder order) into
+  // the greyscale DMA buffer, latch bits included.
+  void encode(const uint8_t* rgb, ESP32_GREY_DMA_STORAGE_TYPE* out) const;
+
+  // Same, but only for the scan lines set in rows (bit n = scan line n), the
+  // rest of out is left as it is.
+  void encodeRows(const uint8_t* rgb, ESP32_GREY_DMA_STORAGE_TYPE* out,
+                  uint32_t rows) const;
+
+ private:
+  void encodeRow(const uint8_t* rgb, ESP32_GREY_DMA_STORAGE_TYPE* out) const;
+
+  MBI_PanelGeometry geometry;
+  uint16_t colour_lut[3][256];  // R, G, B
+};
@@ -0,0 +1,86 @@
+/******************************************************************************************
+ * @file        mbi_panel_geometry.hpp
+ * @brief       Runtime geometry of an MBI5153 based LED Matrix Panel
+ ******************************************************************************************/
+
+/*
+  Everything that sizes the greyscale DMA buffer, the GCLK / address line payload and the
+  pixel address map. The defaults describe the 78x78 upcycled panel; other boards or
+  chained panels only need a different descriptor passed to the UMatrix constructor.
+
+  Fixed by the hardware and therefore not part of the descriptor: 16 LED channels per
+  MBI5153, and the 4 quarter-panel lanes wired to the 12 RGB data lines.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "UMatrixSettings.hpp"
+
+// Number of 20 row quarter-panel lanes sharing each DMA word (R1..R4, G1..G4, B1..B4)
+#define PANEL_MBI_LANES         4
+
+// Number of DMA words per MBI5153 channel (16-bit greyscale value, MSB first)
+#define PANEL_MBI_GREY_BITS     16
+
+// Largest GCLK payload a single configurable SPI segment can carry
+#define PANEL_SPI_SEGMENT_MAX     32768
+
+struct MBI_PanelGeometry {
+  uint16_t res_x = PANEL_RES_X;            // visible pixels
+  uint16_t res_y = PANEL_RES_Y;
+  uint8_t scan_lines = PANEL_SCAN_LINES;   // rows per lane, multiplexed by the address lines
+  uint8_t chain_len = PANEL_MBI_CHAIN_LEN; // MBI5153s chained per data line
+  uint8_t offset_x = 2;                    // dead columns on the left
+  uint8_t offset_y = 0;                    // dead rows on the top
+
+  // Pixels the MBI5153 chain can address
+  uint16_t mbiResX() const { return chain_len * PANEL_MBI_LED_CHANS; }
+  uint16_t mbiResY() const { return scan_lines * PANEL_MBI_LANES; }
+
+  // Framebuffer slots (one per addressable pixel) and greyscale DMA words
+  size_t rowSlots() const { return mbiResX() * PANEL_MBI_LANES; }
+  size_t rowWords() const { return mbiResX() * PANEL_MBI_GREY_BITS; }
+  size_t pixelCount() const { return rowSlots() * scan_lines; }
+  size_t greyWords() const { return rowWords() * scan_lines; }
+
+  // Bit mask with one bit per scan line
+  uint32_t allRows() const {
+    return scan_lines >= 32 ? 0xFFFFFFFFUL : (1UL << scan_lines) - 1;
+  }
+
+  // GCLK and address line payload for the given GCLKs per row, see
+  // spi_dma_seg_tx_payload.h (3 bytes per GCLK plus 8 bytes padding either side)
+  size_t gclkPayloadBytes(int gclks_per_row) const {
+    return (8 + gclks_per_row * 3 + 8) * scan_lines;
+  }
+
+  bool isValid(int gclks_per_row = 513) const {
+    return res_x > 0 && res_y > 0 && scan_lines > 0 &&
+           scan_lines <= PANEL_MBI_MAX_SCAN_LINES && chain_len > 0 &&
+           chain_len <= PANEL_MBI_MAX_CHAIN_LEN &&
+           res_x + offset_x <= mbiResX() && res_y + offset_y <= mbiResY() &&
+           gclkPayloadBytes(gclks_per_row) < PANEL_SPI_SEGMENT_MAX;
+  }
+};
+
+// How the MBI5153 spreads its PWM over the scan lines, see config register 1. The GCLK
+// multiplier halves the GCLKs per row, so the rows are scanned twice as often; 13-bit
+// greyscale halves the number of scans it takes to show every grey level.
+struct MBI_ScanMode {
+  bool gclk_multiplier = false;
+  bool grey_13bit = false;
+
+  int gclksPerRow() const {
+    return gclk_multiplier ? gclk_per_row_multiplied : gclk_per_row;
+  }
+  int greyBits() const { return grey_13bit ? 13 : 14; }
+
+  bool operator==(const MBI_ScanMode& other) const {
+    return gclk_multiplier == other.gclk_multiplier &&
+           grey_13bit == other.grey_13bit;
+  }
+  bool operator!=(const MBI_ScanMode& other) const { return !(*this == other); }
+};
@@ -41,6 +41,7 @@
 
 // Custom includes
 #include "MBI5153/UMatrixSettings.hpp"
+#include "MBI5153/UMatrixPins.hpp"
 
 #include "spi_dma_seg_tx_loop.h"
 #include "spi_dma_seg_tx_payload.h"
@@ -180,7 +181,7 @@ void lldesc_setup_chain(lldesc_t *dmadesc, int dma_desc_count, bool loop) {
 
 }
 /**************************************************************************************/
-esp_err_t spi_setup(void)
+esp_err_t spi_setup(int scan_lines, int gclks_per_row)
 {
   esp_err_t err;
 
@@ -246,7 +247,7 @@ esp_err_t spi_setup(void)
   // Set the GCLK Frequency
   // Note: The frequency of GCLK must be higher than 20% of DCLK to get the correct gray scale data.  
   //device_conf.clock_speed_hz  = SPI_MASTER_FREQ_8M/2; // 4Mhz
-  device_conf.clock_speed_hz  = 5 * 1000 * 1000; // 3Mhz
+  device_conf.clock_speed_hz  = PANEL_GCLK_SPI_HZ; // 5Mhz
   
   device_conf.duty_cycle_pos  = 0;
   device_conf.cs_ena_pretrans = device_conf.cs_ena_posttrans = 0;
@@ -260,7 +261,7 @@ esp_err_t spi_setup(void)
   log_d("spi_setup() complete");  
 
   // populate payload
-  allocate_gclk_dma_memory();
+  allocate_gclk_dma_memory(scan_lines, gclks_per_row);
 
   // Send it once
   spi_transfer_initial_payload();
@@ -287,7 +288,7 @@ esp_err_t spi_transfer_initial_payload()
   // https://www.esp32.com/viewtopic.php?p=123221#p123211
   trans.tx_buffer = spi_tx_octal_payload; 
   //trans.length = (sizeof(spi_tx_octal_payload)) * 8;
-  trans.length = GCLK_TOTAL_SIZE * 8;
+  trans.length = gclk_total_size * 8;
   trans.rx_buffer = NULL; 
   trans.rxlength = 0;
 
@@ -331,7 +332,7 @@ esp_err_t spi_dma_seg_setup()
 
   // SPI_MS_DLEN_REG
   //spi_seg_conf_1[2] = (sizeof(spi_tx_octal_payload) * 8) -1; // must match exactly the dma payload total chunk size -1
-  spi_seg_conf_1[2] = (GCLK_TOTAL_SIZE * 8) -1; // must match exactly the dma payload total chunk size -1
+  spi_seg_conf_1[2] = (gclk_total_size * 8) -1; // must match exactly the dma payload total chunk size -1
 
 
   // Set up linked lists for next descriptors
@@ -339,7 +340,7 @@ esp_err_t spi_dma_seg_setup()
 
   dma_lldesc_required = 1; // for CONF dma lldesc 
   //dma_lldesc_required += lldesc_get_required_num(sizeof(spi_tx_octal_payload)); 
-  dma_lldesc_required += lldesc_get_required_num(GCLK_TOTAL_SIZE * sizeof(uint8_t)); 
+  dma_lldesc_required += lldesc_get_required_num(gclk_total_size * sizeof(uint8_t)); 
   log_i("%d SPI DMA descriptors required for cover spi_tx_payload_chunk2 data.", dma_lldesc_required);   
 
   // Allocate memory
@@ -349,7 +350,7 @@ esp_err_t spi_dma_seg_setup()
   int offset = 0;
   offset = lldesc_setup_chunk(dma_data_lldesc, &spi_seg_conf_1, 4*3, 0); // setup dma link list descriptor for CONF data
   //offset = lldesc_setup_chunk(dma_data_lldesc, &spi_tx_octal_payload, sizeof(spi_tx_octal_payload), offset); // setup dma link list descriptors for payload
-  offset = lldesc_setup_chunk(dma_data_lldesc, spi_tx_octal_payload, (GCLK_TOTAL_SIZE * sizeof(uint8_t)), offset); // setup dma link list descriptors for payload
+  offset = lldesc_setup_chunk(dma_data_lldesc, spi_tx_octal_payload, (gclk_total_size * sizeof(uint8_t)), offset); // setup dma link list descriptors for payload
 
   lldesc_setup_chain(dma_data_lldesc, dma_lldesc_required, true); // link them all together
 
@@ -357,6 +358,43 @@ esp_err_t spi_dma_seg_setup()
 
 }
 
+// Swap in a payload with a different number of GCLKs per row. The loop is
+// stopped at the end of its segment, the payload and the segment descriptors
+// rebuilt, and the loop restarted.
+esp_err_t spi_set_gclks_per_row(int gclks_per_row)
+{
+  if (gclks_per_row == gclk_repeats) {
+    return ESP_OK;
+  }
+
+  spi_transfer_loop_stop();
+  while (GPSPI2.cmd.usr);  // whole segmented transfer over, the DMA is done with the payload
+
+  allocate_gclk_dma_memory(gclk_rows, gclks_per_row);
+
+  heap_caps_free(dma_data_lldesc);
+  dma_data_lldesc = NULL;
+  dma_lldesc_required = 0;
+  spi_dma_seg_setup();
+
+  return spi_transfer_loop_start();
+}
+
+int spi_get_gclks_per_row()
+{
+  return gclk_repeats;
+}
+
+int spi_get_payload_size()
+{
+  return gclk_total_size;
+}
+
+const uint8_t* spi_get_payload()
+{
+  return spi_tx_octal_payload;
+}
+
 esp_err_t spi_transfer_loop_start()
 {
   esp_err_t ret;
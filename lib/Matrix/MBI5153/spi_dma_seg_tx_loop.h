@@ -26,7 +26,11 @@ extern "C"
 {
 #endif
 
-esp_err_t spi_setup(void);
+esp_err_t spi_setup(int scan_lines, int gclks_per_row); // GCLK / address payload for this many rows
+esp_err_t spi_set_gclks_per_row(int gclks_per_row);     // regenerate the payload and restart the loop
+int       spi_get_gclks_per_row();
+int       spi_get_payload_size();                       // bytes per loop, one per SPI clock
+const uint8_t* spi_get_payload();                       // the looping GCLK / address payload
 esp_err_t spi_transfer_loop_start(void);
 esp_err_t spi_transfer_loop_stop(void); // generates interrupt
 
@@ -21,21 +21,23 @@ For any extra code that is generated to print the output of this propsoed code s
 */
 
 const int BYTES_PER_REPEAT  = 3; // gclk pulse on 3rd byte, gives us enough time to send frame data then.
-const int REPEATS           = 513; // 513 gclks per the documentation
-const int SEQUENCE_SIZE     = BYTES_PER_REPEAT * REPEATS;
-const int REPEAT_COUNT      = 20; // 20 rows
 const int PADDING_SIZE      = 8; // some delay between row changes?
-const int GCLK_TOTAL_SIZE   = (PADDING_SIZE + SEQUENCE_SIZE + PADDING_SIZE) * REPEAT_COUNT;
 
-// GCLK_TOTAL_SIZE = 31100 which is just under the SPI max transfer size of 32kB per SEGMENT
+// Set from the panel geometry and scan mode by allocate_gclk_dma_memory()
+static int gclk_repeats       = 513; // 513 gclks per the documentation, 257 with the GCLK multiplier
+static int gclk_sequence_size = BYTES_PER_REPEAT * 513;
+static int gclk_rows          = 20; // 20 rows
+static int gclk_total_size    = 0;  // (PADDING_SIZE + gclk_sequence_size + PADDING_SIZE) * gclk_rows
+
+// gclk_total_size = 31100 for 20 rows, which is just under the SPI max transfer size of 32kB per SEGMENT
 
 DMA_ATTR static uint8_t *spi_tx_octal_payload   = NULL; // data for gclk
 
 // Generate MBI5153 GCLK DATA for Byte 0 of parallel output.
 // Function to calculate the value of a byte at a specific position
 uint8_t getByteValue(int position) {
-    int sequenceIndex = position / (PADDING_SIZE + SEQUENCE_SIZE + PADDING_SIZE);
-    int offset = position % (PADDING_SIZE + SEQUENCE_SIZE + PADDING_SIZE);
+    int sequenceIndex = position / (PADDING_SIZE + gclk_sequence_size + PADDING_SIZE);
+    int offset = position % (PADDING_SIZE + gclk_sequence_size + PADDING_SIZE);
 
     // Calculate position within the sequence
     int sequencePosition = offset - PADDING_SIZE;
@@ -44,7 +46,7 @@ uint8_t getByteValue(int position) {
     uint8_t repeatValue = sequenceIndex & 0x1F;  // Repeat value embedded in the LSBs
 
     // Handle padding
-    if (offset < PADDING_SIZE || offset >= PADDING_SIZE + SEQUENCE_SIZE) {
+    if (offset < PADDING_SIZE || offset >= PADDING_SIZE + gclk_sequence_size) {
 		// return (repeatValue << 2);
 
 		// fix slight gclk sync out of sync on ESP32S3... causes gclk to get out of sync with rowscan and image to slide around
@@ -81,20 +83,21 @@ int main() {
 */
 
 
-void allocate_gclk_dma_memory()
+// (Re)generate the payload. The SPI loop must not be running.
+void allocate_gclk_dma_memory(int rows, int gclks_per_row)
 {
-	/*
 	if (spi_tx_octal_payload != NULL) {
-          ESP_LOGE("spi_dma_seg_tx_payload", "Looks like we've already called allocate_gclk_dma_memory()!");  		
-		  return;
+		heap_caps_free(spi_tx_octal_payload);
+		spi_tx_octal_payload = NULL;
 	}
-	*/
-    
-	// We don't want to do this twice
-	assert(spi_tx_octal_payload == NULL);
+
+	gclk_rows = rows;
+	gclk_repeats = gclks_per_row;
+	gclk_sequence_size = BYTES_PER_REPEAT * gclk_repeats;
+	gclk_total_size = (PADDING_SIZE + gclk_sequence_size + PADDING_SIZE) * gclk_rows;
 
 	// Allocate
-          size_t alloc_size_bytes  = (GCLK_TOTAL_SIZE) * sizeof(uint8_t);
+          size_t alloc_size_bytes  = (gclk_total_size) * sizeof(uint8_t);
           size_t actual_size = 0;
 
 #ifdef USE_PSRAM
@@ -109,7 +112,7 @@ void allocate_gclk_dma_memory()
           actual_size = alloc_size_bytes;
 #endif
 
-	ESP_LOGI("spi_dma_seg_tx_payload", "GCLK data total size: %d bytes.", GCLK_TOTAL_SIZE);  
+	ESP_LOGI("spi_dma_seg_tx_payload", "GCLK data total size: %d bytes for %d rows of %d GCLKs.", gclk_total_size, gclk_rows, gclk_repeats);  
 
 	// Populate based on algo
 	for (int i = 0; i < alloc_size_bytes; i++) {
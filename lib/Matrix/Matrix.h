@@ -3,6 +3,11 @@
 #include <Arduino.h>
 #include "PVector.h"
 #include "GFX_Layer.hpp"
+#include "LayerCompositor.hpp"
+#include "Rasterizer.hpp"
+#include "TextLayout.hpp"
+#include "TrackedLayer.hpp"
+#include "Noise8.hpp"
 
 class Matrix {
  protected:
@@ -10,6 +15,15 @@ class Matrix {
   uint8_t brightness = 100;
   uint8_t fontSize;
 
+  // Bumped by anything that changes where drawn content ends up on the panel
+  // (rotation, mirroring), so cached content knows to draw itself again
+  uint32_t content_generation = 0;
+  uint32_t idle_frames = 0;
+
+  // Compositor layer each GFX layer's display() draws into, see displayInto()
+  LayerId background_target = LAYER_BACKGROUND;
+  LayerId foreground_target = LAYER_SCENE;
+
  public:
   virtual ~Matrix() = default;
 
@@ -18,7 +32,21 @@ class Matrix {
   virtual void drawPixelRGB888(uint16_t x, uint16_t y, uint8_t r_data, uint8_t g_data,
                      uint8_t b_data) = 0;
 
+  // Whole frame at once into the background layer, row major at the matrix
+  // resolution: 3 bytes per pixel if rgb, otherwise one grey byte
+  void drawFrame(const uint8_t* data, bool rgb) {
+    LayerCompositor::LayerSink layer = compositor.sink(LAYER_BACKGROUND);
+    if (rgb) {
+      layer.drawFrameRGB888(data, getXResolution(), getYResolution());
+    } else {
+      layer.drawFrameGrey(data, getXResolution(), getYResolution());
+    }
+  }
+
   virtual void setBrightness(uint8_t newBrightness) = 0;
+  // Per channel gain for colour calibration, 255 = unity. Ignored by panels
+  // without their own colour LUT.
+  virtual void setWhiteBalance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain) {}
   virtual uint8_t getBrightness() const = 0;
   virtual uint8_t getXResolution() = 0;
   virtual uint8_t getYResolution() = 0;
@@ -29,7 +57,30 @@ class Matrix {
 
   virtual void update() = 0;
 
+  // Instead of update(), when the frame would be exactly the last one: nothing
+  // is drawn, composited, encoded or sent, the panel keeps showing what it has.
+  virtual void holdFrame() { idle_frames++; }
+  uint32_t getIdleFrames() const { return idle_frames; }
+  uint32_t getContentGeneration() const { return content_generation; }
+
+  // Draw a GFX layer into another compositor layer than its usual one, e.g.
+  // the menu on top of whatever the mode shows
+  void displayInto(GFX_Layer* layer, LayerId id) {
+    LayerId& target = (layer == foreground) ? foreground_target : background_target;
+    LayerId previous = target;
+    target = id;
+    layer->display();
+    target = previous;
+  }
+
+  // Span drawing straight into a compositor layer, for shapes drawn in bulk.
+  // GFX layers displayed into the same layer later go on top.
+  Rasterizer raster(LayerId id) { return Rasterizer(compositor, id); }
+
+  // Everything drawn ends up here, update() composites it into the frame
+  LayerCompositor compositor;
+
   GFX_Layer* background = nullptr;
-  GFX_Layer* foreground = nullptr;
+  TrackedLayer* foreground = nullptr;  // cleared every frame, only where drawn
   GFX_LayerCompositor* gfx_compositor = nullptr;
 };
\ No newline at end of file
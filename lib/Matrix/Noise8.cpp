@@ -0,0 +1,157 @@
+#include "Noise8.hpp"
+
+// FastLED's permutation, Ken Perlin's, with the first entry again at the end
+// for the "+ 1" lookups
+static const uint8_t p[257] = {
+    151, 160, 137, 91,  90,  15,  131, 13,  201, 95,  96,  53,  194, 233, 7,   225, 140, 36,
+    103, 30,  69,  142, 8,   99,  37,  240, 21,  10,  23,  190, 6,   148, 247, 120, 234, 75,
+    0,   26,  197, 62,  94,  252, 219, 203, 117, 35,  11,  32,  57,  177, 33,  88,  237, 149,
+    56,  87,  174, 20,  125, 136, 171, 168, 68,  175, 74,  165, 71,  134, 139, 48,  27,  166,
+    77,  146, 158, 231, 83,  111, 229, 122, 60,  211, 133, 230, 220, 105, 92,  41,  55,  46,
+    245, 40,  244, 102, 143, 54,  65,  25,  63,  161, 1,   216, 80,  73,  209, 76,  132, 187,
+    208, 89,  18,  169, 200, 196, 135, 130, 116, 188, 159, 86,  164, 100, 109, 198, 173, 186,
+    3,   64,  52,  217, 226, 250, 124, 123, 5,   202, 38,  147, 118, 126, 255, 82,  85,  212,
+    207, 206, 59,  227, 47,  16,  58,  17,  182, 189, 28,  42,  223, 183, 170, 213, 119, 248,
+    152, 2,   44,  154, 163, 70,  221, 153, 101, 155, 167, 43,  172, 9,   129, 22,  39,  253,
+    19,  98,  108, 110, 79,  113, 224, 232, 178, 185, 112, 104, 218, 246, 97,  228, 251, 34,
+    242, 193, 238, 210, 144, 12,  191, 179, 162, 241, 81,  51,  145, 235, 249, 14,  239, 107,
+    49,  192, 214, 31,  181, 199, 106, 157, 184, 84,  204, 176, 115, 121, 50,  45,  127, 4,
+    150, 254, 138, 236, 205, 93,  222, 114, 67,  29,  24,  72,  243, 141, 128, 195, 78,  66,
+    215, 61,  156, 180, 151};
+
+// Inlined even at -Os, these run per sample
+#define NOISE_INLINE static inline __attribute__((always_inline))
+
+// ease8InOutQuad() for every fraction
+static uint8_t ease_table[256];
+static bool ease_table_built = false;
+
+static const uint8_t* easeTable() {
+  if (!ease_table_built) {
+    for (int i = 0; i < 256; i++) {
+      uint8_t j = i & 0x80 ? 255 - i : i;
+      uint8_t jj2 = ((j * (1 + j)) >> 8) << 1;
+      ease_table[i] = i & 0x80 ? 255 - jj2 : jj2;
+    }
+    ease_table_built = true;
+  }
+  return ease_table;
+}
+
+NOISE_INLINE int8_t lerp7by8(int8_t a, int8_t b, uint8_t frac) {
+  if (b > a) {
+    uint8_t delta = b - a;
+    return a + ((delta * (1 + frac)) >> 8);
+  }
+  uint8_t delta = a - b;
+  return a - ((delta * (1 + frac)) >> 8);
+}
+
+// grad8() ends in avg7(u, v) = (u >> 1) + (v >> 1) + (u & 1), which splits into
+// a part for u and a part for v. Only one of the two is ever x, so a corner's
+// gradient is a constant for the row and cell plus one term in x.
+NOISE_INLINE int8_t uTerm(int8_t u) { return (u >> 1) + (u & 1); }
+NOISE_INLINE int8_t vTerm(int8_t v) { return v >> 1; }
+
+enum XTerm : uint8_t { X_NONE, X_U, X_U_NEG, X_V, X_V_NEG, X_TERMS };
+
+struct Corner {
+  int8_t constant;
+  uint8_t x_term;
+};
+
+NOISE_INLINE Corner corner(uint8_t hash, int8_t y, int8_t z) {
+  hash &= 0xF;
+  Corner k;
+  if (!(hash & 8)) {  // u is x
+    int8_t v = hash < 4 ? y : z;
+    k.constant = vTerm(hash & 2 ? -v : v);
+    k.x_term = hash & 1 ? X_U_NEG : X_U;
+  } else {  // u is y
+    k.constant = uTerm(hash & 1 ? -y : y);
+    if (hash == 12 || hash == 14) {
+      k.x_term = hash & 2 ? X_V_NEG : X_V;
+    } else {
+      k.constant += vTerm(hash & 2 ? -z : z);
+      k.x_term = X_NONE;
+    }
+  }
+  return k;
+}
+
+NOISE_INLINE void xTerms(int8_t x, int8_t* terms) {
+  int8_t neg = -x;  // -(-128) stays -128, as it does in grad8()
+  terms[X_NONE] = 0;
+  terms[X_U] = uTerm(x);
+  terms[X_U_NEG] = uTerm(neg);
+  terms[X_V] = vTerm(x);
+  terms[X_V_NEG] = vTerm(neg);
+}
+
+void inoise8Row(uint8_t* out, size_t count, uint16_t x, uint16_t step, uint16_t y, uint16_t z) {
+  const uint8_t* ease = easeTable();
+
+  // The same for the whole row
+  const uint8_t Y = y >> 8;
+  const uint8_t Z = z >> 8;
+  const uint8_t v = ease[y & 0xFF];
+  const uint8_t w = ease[z & 0xFF];
+  const int8_t yy = (y & 0xFF) >> 1;
+  const int8_t zz = (z & 0xFF) >> 1;
+  const int8_t yy1 = yy - 128;
+  const int8_t zz1 = zz - 128;
+
+  // Corners of the current cell in inoise8_raw()'s order, even ones on the
+  // cell's left
+  Corner corners[8];
+  int16_t cell = -1;
+
+  int8_t terms[2][X_TERMS];
+  for (size_t i = 0; i < count; i++, x += step) {
+    const uint8_t X = x >> 8;
+    if (X != cell) {
+      uint8_t A = p[X] + Y;
+      uint8_t AA = p[A] + Z;
+      uint8_t AB = p[A + 1] + Z;
+      uint8_t B = p[X + 1] + Y;
+      uint8_t BA = p[B] + Z;
+      uint8_t BB = p[B + 1] + Z;
+      corners[0] = corner(p[AA], yy, zz);
+      corners[1] = corner(p[BA], yy, zz);
+      corners[2] = corner(p[AB], yy1, zz);
+      corners[3] = corner(p[BB], yy1, zz);
+      corners[4] = corner(p[AA + 1], yy, zz1);
+      corners[5] = corner(p[BA + 1], yy, zz1);
+      corners[6] = corner(p[AB + 1], yy1, zz1);
+      corners[7] = corner(p[BB + 1], yy1, zz1);
+      cell = X;
+    }
+
+    const int8_t xx = (x & 0xFF) >> 1;
+    xTerms(xx, terms[0]);
+    xTerms(xx - 128, terms[1]);
+    int8_t g[8];
+    for (uint8_t c = 0; c < 8; c++) {
+      g[c] = corners[c].constant + terms[c & 1][corners[c].x_term];
+    }
+
+    const uint8_t u = ease[x & 0xFF];
+    int8_t X1 = lerp7by8(g[0], g[1], u);
+    int8_t X2 = lerp7by8(g[2], g[3], u);
+    int8_t X3 = lerp7by8(g[4], g[5], u);
+    int8_t X4 = lerp7by8(g[6], g[7], u);
+    int8_t Y1 = lerp7by8(X1, X2, v);
+    int8_t Y2 = lerp7by8(X3, X4, v);
+    int8_t raw = lerp7by8(Y1, Y2, w);  // -64..64
+
+    uint8_t n = raw + 64;
+    out[i] = n > 127 ? 255 : n + n;
+  }
+}
+
+void inoise8Tile(uint8_t* out, size_t stride, size_t width, size_t height, uint16_t x,
+                 uint16_t x_step, uint16_t y, uint16_t y_step, uint16_t z) {
+  for (size_t j = 0; j < height; j++, y += y_step) {
+    inoise8Row(out + j * stride, width, x, x_step, y, z);
+  }
+}
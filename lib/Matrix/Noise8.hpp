@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FastLED's inoise8() for many samples at once. Along a row only x moves, so
+// the lattice hashes and gradients of a cell are looked up once for all the
+// samples that fall into it (about 256 / step of them), and y and z's fade
+// and offsets once for the whole row. The fade curve is a table.
+//
+// Bit for bit what inoise8() returns for each sample, see test/test_noise8.
+
+// out[i] = inoise8(x + i * step, y, z), coordinates wrapping at 16 bits as
+// they do when passed to inoise8()
+void inoise8Row(uint8_t* out, size_t count, uint16_t x, uint16_t step, uint16_t y, uint16_t z);
+
+// height rows of width samples, row j at out + j * stride being
+// inoise8Row(x, x_step, y + j * y_step, z)
+void inoise8Tile(uint8_t* out, size_t stride, size_t width, size_t height, uint16_t x,
+                 uint16_t x_step, uint16_t y, uint16_t y_step, uint16_t z);
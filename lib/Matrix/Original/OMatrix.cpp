@@ -13,23 +13,30 @@ OMatrix::OMatrix() {
 #ifdef DOUBLE_BUFFER
   mxconfig.double_buff = true;
 #endif
-  matrix = new MatrixPanel_I2S_DMA(mxconfig);
+  matrix = new OMatrixPanel(mxconfig);
   matrix->begin();
   matrix->setBrightness8(brightness);  // 0-255
   matrix->clearScreen();
 
+#ifdef DIRECT_FRAME
+  frame = (CRGB*)heap_caps_calloc(PANEL_RES_X * PANEL_RES_Y, sizeof(CRGB),
+                                  MALLOC_CAP_INTERNAL);
+  assert(frame != nullptr);
+#endif
+  compositor.begin(PANEL_RES_X, PANEL_RES_Y);
+
   background = new GFX_Layer(PANEL_RES_X, PANEL_RES_Y, 
     [this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
-        matrix->drawPixelRGB888(x, y, r, g, b);
+        compositor.writePixel(background_target, x, y, r, g, b);
     });
 
-  foreground = new GFX_Layer(PANEL_RES_X, PANEL_RES_Y, 
+  foreground = new TrackedLayer(PANEL_RES_X, PANEL_RES_Y, 
     [this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
-        matrix->drawPixelRGB888(x, y, r, g, b);
+        compositor.writePixel(foreground_target, x, y, r, g, b);
     });
 
   gfx_compositor = new GFX_LayerCompositor([this](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
-        matrix->drawPixelRGB888(x, y, r, g, b);
+        compositor.writePixel(background_target, x, y, r, g, b);
     });
 }
 
@@ -52,7 +59,7 @@ uint8_t OMatrix::getXResolution() {
 
 void OMatrix::drawPixelRGB888(uint16_t x, uint16_t y, uint8_t r_data,
                               uint8_t g_data, uint8_t b_data) {
-  matrix->drawPixelRGB888(x, y, r_data, g_data, b_data);
+  compositor.writePixel(LAYER_BACKGROUND, x, y, r_data, g_data, b_data);
 }
 
 uint8_t OMatrix::getYResolution() {
@@ -62,16 +69,26 @@ uint8_t OMatrix::getYResolution() {
 void OMatrix::setRotation(uint8_t newRotation) {
   if ((newRotation < 4) && (newRotation != rotation)) {
     rotation = newRotation;
+    content_generation++;
     matrix->setRotation(rotation);
   }
 }
 
 void OMatrix::rotate90() {
   if (++rotation > 3) rotation = 0;
+  content_generation++;
   matrix->setRotation(rotation);
 }
 
 void OMatrix::update() {
+#ifdef DIRECT_FRAME
+  compositor.composite(sink);
+  matrix->pushFrame(frame, PANEL_RES_X, PANEL_RES_Y, rotation);
+  memset(frame, 0, PANEL_RES_X * PANEL_RES_Y * sizeof(CRGB));
+#else
+  // The DMA buffer keeps the last frame, every pixel is written again
+  compositor.composite(sink, true);
+#endif
 #ifdef DOUBLE_BUFFER
   matrix->flipDMABuffer();
   // matrix->clearScreen();
@@ -79,5 +96,10 @@ void OMatrix::update() {
 }
 
 void OMatrix::clearScreen() {
+  compositor.clearAll();
+#ifdef DIRECT_FRAME
+  memset(frame, 0, PANEL_RES_X * PANEL_RES_Y * sizeof(CRGB));
+#else
   matrix->clearScreen();
+#endif
 }
\ No newline at end of file
@@ -3,13 +3,48 @@
 #include <Arduino.h>
 #include <ESP32-HUB75-MatrixPanel-I2S-DMA.h>
 #include "OMatrixSettings.h"
+#include "OMatrixPanel.h"
 #include "GFX_Layer.hpp"
 #include "Matrix.h"
+#include "PixelSink.hpp"
 
 class OMatrix : public Matrix {
+  friend class Benchmark;
+
  private:
   HUB75_I2S_CFG::i2s_pins _pins = {RL1, GL1, BL1, RL2, GL2, BL2, CH_A, CH_B, CH_C, CH_D, CH_E, LAT, OE, CLK};
-  MatrixPanel_I2S_DMA* matrix = nullptr;
+  OMatrixPanel* matrix = nullptr;
+
+#ifdef DIRECT_FRAME
+  CRGB* frame = nullptr;  // PANEL_RES_X x PANEL_RES_Y, logical coordinates
+
+  inline void storePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+    if (x < 0 || y < 0 || x >= PANEL_RES_X || y >= PANEL_RES_Y)
+      return;
+
+    frame[y * PANEL_RES_X + x] = CRGB(r, g, b);
+  }
+
+  // Bulk writes into frame with storePixel() inlined, the compositor's
+  // output, see PixelSink
+  struct FrameSink : PixelSink<FrameSink> {
+    OMatrix* owner;
+    explicit FrameSink(OMatrix* owner) : owner(owner) {}
+    inline void writePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+      owner->storePixel(x, y, r, g, b);
+    }
+  };
+#else
+  // The compositor's output, straight into the library's DMA buffer
+  struct FrameSink : PixelSink<FrameSink> {
+    OMatrix* owner;
+    explicit FrameSink(OMatrix* owner) : owner(owner) {}
+    inline void writePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+      owner->matrix->drawPixelRGB888(x, y, r, g, b);
+    }
+  };
+#endif
+  FrameSink sink{this};
 
  public:
   OMatrix();
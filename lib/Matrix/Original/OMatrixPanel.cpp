@@ -0,0 +1,109 @@
+#include "OMatrixPanel.h"
+
+// RGB bits of a DMA word: R1 G1 B1 for the top half of the panel, R2 G2 B2 for
+// the bottom half, the rest is LAT / OE / address and must be kept.
+#define WORD_RGB1_SHIFT 0
+#define WORD_RGB2_SHIFT 3
+#define WORD_RGB_BITS   0x3F
+
+bool OMatrixPanel::begin() {
+  if (!MatrixPanel_I2S_DMA::begin()) {
+    return false;
+  }
+
+  line_planes = (uint16_t*)heap_caps_malloc(
+      dma_buff.rowBits[0]->width * 6 * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+  if (line_planes == nullptr) {
+    log_e("OMatrixPanel: not enough memory, bulk frame path disabled");
+    return true;
+  }
+
+  buildPlaneTable();
+  return true;
+}
+
+// Read back which bit planes the library's own per-pixel path sets for every
+// value, so the bulk path uses the same brightness curve and colour depth.
+void OMatrixPanel::buildPlaneTable() {
+  const uint8_t depth = dma_buff.rowBits[0]->colour_depth;
+
+  for (int v = 0; v < 256; v++) {
+    drawPixelRGB888(0, 0, v, 0, 0);
+    planes[v] = 0;
+    for (uint8_t d = 0; d < depth; d++) {
+      ESP32_I2S_DMA_STORAGE_TYPE* p = dma_buff.rowBits[0]->getDataPtr(d, back_buffer_id);
+      if (p[0] & (1 << WORD_RGB1_SHIFT)) {
+        planes[v] |= 1 << d;
+      }
+    }
+  }
+  drawPixelRGB888(0, 0, 0, 0, 0);
+
+  planes_ready = true;
+}
+
+void OMatrixPanel::pushFrame(const CRGB* frame, uint16_t frame_width,
+                             uint16_t frame_height, uint8_t rotation) {
+  if (!planes_ready) {
+    return;
+  }
+
+  const uint16_t width = dma_buff.rowBits[0]->width;  // whole chain
+  const uint8_t rows = dma_buff.rows;                 // two pixel rows each
+  const uint8_t depth = dma_buff.rowBits[0]->colour_depth;
+  const uint16_t height = rows * 2;
+
+  for (uint8_t row = 0; row < rows; row++) {
+    // Gather the top and bottom pixel rows, inverse of the GFX rotation
+    for (uint16_t x = 0; x < width; x++) {
+      for (int half = 0; half < 2; half++) {
+        uint16_t y = row + half * rows;
+        int lx, ly;
+        switch (rotation) {
+          case 1:  lx = y;              ly = width - 1 - x;  break;
+          case 2:  lx = width - 1 - x;  ly = height - 1 - y; break;
+          case 3:  lx = height - 1 - y; ly = x;              break;
+          default: lx = x;              ly = y;              break;
+        }
+
+        uint16_t* lp = &line_planes[x * 6 + half * 3];
+        if (lx < frame_width && ly < frame_height) {
+          const CRGB& c = frame[ly * frame_width + lx];
+          lp[0] = planes[c.r];
+          lp[1] = planes[c.g];
+          lp[2] = planes[c.b];
+        } else {
+          lp[0] = lp[1] = lp[2] = 0;
+        }
+      }
+    }
+
+    // One pass per bit plane, each word written once
+    for (uint8_t d = 0; d < depth; d++) {
+      ESP32_I2S_DMA_STORAGE_TYPE* p = dma_buff.rowBits[row]->getDataPtr(d, back_buffer_id);
+      const uint16_t* lp = line_planes;
+      for (uint16_t x = 0; x < width; x++, lp += 6) {
+        uint16_t bits = ((lp[0] >> d) & 1) | (((lp[1] >> d) & 1) << 1) |
+                        (((lp[2] >> d) & 1) << 2) | (((lp[3] >> d) & 1) << 3) |
+                        (((lp[4] >> d) & 1) << 4) | (((lp[5] >> d) & 1) << 5);
+        p[x] = (p[x] & ~WORD_RGB_BITS) | bits;
+      }
+    }
+  }
+}
+
+uint32_t OMatrixPanel::backBufferHash() {
+  const uint16_t width = dma_buff.rowBits[0]->width;
+  const uint8_t depth = dma_buff.rowBits[0]->colour_depth;
+
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (uint8_t row = 0; row < dma_buff.rows; row++) {
+    for (uint8_t d = 0; d < depth; d++) {
+      ESP32_I2S_DMA_STORAGE_TYPE* p = dma_buff.rowBits[row]->getDataPtr(d, back_buffer_id);
+      for (uint16_t x = 0; x < width; x++) {
+        hash = (hash ^ (p[x] & WORD_RGB_BITS)) * 16777619u;
+      }
+    }
+  }
+  return hash;
+}
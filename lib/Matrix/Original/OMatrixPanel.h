@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESP32-HUB75-MatrixPanel-I2S-DMA.h>
+
+// MatrixPanel_I2S_DMA with a bulk write of a whole RGB888 frame. drawPixelRGB888()
+// converts every pixel on its own, through every colour depth bit plane; pushFrame()
+// walks the DMA buffer row by row instead and writes each word once.
+class OMatrixPanel : public MatrixPanel_I2S_DMA {
+ public:
+  explicit OMatrixPanel(const HUB75_I2S_CFG& cfg) : MatrixPanel_I2S_DMA(cfg) {}
+
+  bool begin();
+
+  // Write frame (frame_width x frame_height, row major, logical coordinates) into
+  // the back buffer, rotated like drawPixelRGB888() would. Pixels the frame
+  // doesn't cover are cleared. Flip the buffer afterwards when double buffering.
+  void pushFrame(const CRGB* frame, uint16_t frame_width, uint16_t frame_height,
+                 uint8_t rotation);
+
+  // Hash of the RGB bits in the back buffer, to compare drawing paths
+  uint32_t backBufferHash();
+
+ private:
+  void buildPlaneTable();
+
+  // Bit n set = colour depth bit plane n is on for this 8-bit value
+  uint16_t planes[256];
+  bool planes_ready = false;
+
+  uint16_t* line_planes = nullptr;  // one row of pixel pairs, 6 channels each
+};
@@ -39,4 +39,14 @@
 #define PANEL_RES_Y 64     // Number of pixels tall of each INDIVIDUAL panel module.
 #define PANEL_CHAIN 1      // Total number of panels chained one to another
 
-// #define DOUBLE_BUFFER 1
+#define DOUBLE_BUFFER 1
+
+// Layers draw into an RGB888 frame that update() writes to the DMA buffer in one
+// pass (see OMatrixPanel::pushFrame) instead of converting every pixel on its own
+#define DIRECT_FRAME 1
+
+// pushFrame() rewrites every row of the buffer it is given, which must not be
+// the one being scanned out
+#if defined(DIRECT_FRAME) && !defined(DOUBLE_BUFFER)
+#error "DIRECT_FRAME needs DOUBLE_BUFFER"
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "GFX_Layer.hpp"
+
+// Compile time pixel sink. A matrix backend derives its sink from
+// PixelSink<Sink> and provides
+//
+//   inline void writePixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b);
+//
+// The bulk routines below are instantiated per sink, so the backend's write is
+// inlined into the loops instead of going through a std::function or a virtual
+// call for every pixel. GFX_Layer itself still needs a std::function for
+// display(), as GFX_Lite doesn't expose the layer's pixels, see the matrix
+// constructors.
+template <class Sink>
+class PixelSink {
+ public:
+  // Row major RGB888 frame, 3 bytes per pixel
+  void drawFrameRGB888(const uint8_t* rgb, uint16_t width, uint16_t height) {
+    for (uint16_t y = 0; y < height; y++) {
+      for (uint16_t x = 0; x < width; x++, rgb += 3) {
+        sink().writePixel(x, y, rgb[0], rgb[1], rgb[2]);
+      }
+    }
+  }
+
+  // Row major 8-bit grey frame
+  void drawFrameGrey(const uint8_t* grey, uint16_t width, uint16_t height) {
+    for (uint16_t y = 0; y < height; y++) {
+      for (uint16_t x = 0; x < width; x++, grey++) {
+        sink().writePixel(x, y, *grey, *grey, *grey);
+      }
+    }
+  }
+
+  // fg over bg, black in fg is transparent (GFX_LayerCompositor::Stack)
+  void stack(const CRGB* bg, const CRGB* fg, uint16_t width, uint16_t height) {
+    for (uint16_t y = 0; y < height; y++) {
+      for (uint16_t x = 0; x < width; x++, bg++, fg++) {
+        const CRGB& c = (fg->r | fg->g | fg->b) ? *fg : *bg;
+        sink().writePixel(x, y, c.r, c.g, c.b);
+      }
+    }
+  }
+
+ private:
+  inline Sink& sink() { return *static_cast<Sink*>(this); }
+};
@@ -0,0 +1,277 @@
+#include "Rasterizer.hpp"
+
+// Span tables for radius 0..MAX_TABLE_RADIUS, radius r at offset r * (r + 1) / 2
+static uint8_t circle_table[(31 + 1) * (31 + 2) / 2];
+static bool circle_table_built = false;
+
+// Adafruit GFX's fillCircle() midpoint walk, which draws vertical lines, turned
+// into the half width of each row
+void Rasterizer::buildSpans(int16_t r, uint8_t* half_widths) {
+  memset(half_widths, 0, r + 1);
+
+  auto column = [&](int16_t dx, int16_t half_height) {
+    for (int16_t dy = 0; dy <= half_height && dy <= r; dy++) {
+      if (half_widths[dy] < dx) {
+        half_widths[dy] = dx;
+      }
+    }
+  };
+  column(0, r);
+
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t px = x;
+  int16_t py = y;
+
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (x < (y + 1)) {
+      column(x, y);
+    }
+    if (y != py) {
+      column(py, px);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+const uint8_t* Rasterizer::circleSpans(int16_t r) {
+  if (!circle_table_built) {
+    for (int16_t i = 0; i <= MAX_TABLE_RADIUS; i++) {
+      buildSpans(i, &circle_table[i * (i + 1) / 2]);
+    }
+    circle_table_built = true;
+  }
+  return r <= MAX_TABLE_RADIUS ? &circle_table[r * (r + 1) / 2] : nullptr;
+}
+
+void Rasterizer::fillCircle(fix_t cx, fix_t cy, fix_t r, const CRGB& c) {
+  int16_t x0 = pixel(cx);
+  int16_t y0 = pixel(cy);
+  int16_t radius = pixel(r);
+  if (radius < 0 || !(c.r | c.g | c.b))
+    return;
+
+  // Nothing of it on the layer
+  if (x0 + radius < 0 || y0 + radius < 0 || x0 - radius > 255 || y0 - radius > 255)
+    return;
+
+  const uint8_t* half_widths = circleSpans(radius);
+  uint8_t large[256];
+  if (half_widths == nullptr) {
+    if (radius > 255)
+      radius = 255;  // covers the whole layer either way
+    buildSpans(radius, large);
+    half_widths = large;
+  }
+
+  compositor.fillSpan(layer, y0, x0 - half_widths[0], x0 + half_widths[0], c);
+  for (int16_t dy = 1; dy <= radius; dy++) {
+    int16_t hw = half_widths[dy];
+    compositor.fillSpan(layer, y0 - dy, x0 - hw, x0 + hw, c);
+    compositor.fillSpan(layer, y0 + dy, x0 - hw, x0 + hw, c);
+  }
+}
+
+// Adafruit GFX's Bresenham walk. A shallow line sets runs of pixels on the
+// same row, each run is one span.
+void Rasterizer::drawLine(fix_t fx0, fix_t fy0, fix_t fx1, fix_t fy1, const CRGB& c) {
+  int16_t x0 = pixel(fx0);
+  int16_t y0 = pixel(fy0);
+  int16_t x1 = pixel(fx1);
+  int16_t y1 = pixel(fy1);
+  if (!(c.r | c.g | c.b))
+    return;
+  if ((x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0))
+    return;
+
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+
+  if (steep) {
+    // One pixel per row
+    for (; x0 <= x1; x0++) {
+      compositor.fillSpan(layer, x0, y0, y0, c);
+      err -= dy;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+    return;
+  }
+
+  int16_t run_start = x0;
+  for (; x0 <= x1; x0++) {
+    err -= dy;
+    if (err < 0 || x0 == x1) {
+      compositor.fillSpan(layer, y0, run_start, x0, c);
+      run_start = x0 + 1;
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+static constexpr fix_t ONE = 1 << RASTER_FRAC_BITS;
+static constexpr fix_t HALF = ONE / 2;
+
+static uint32_t isqrt(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > v) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Coverage of a pixel whose centre is dx, dy from the disc's centre: how far,
+// in 1/256 pixel, the centre lies inside the edge
+void Rasterizer::blendEdge(int16_t x, int16_t y, fix_t dx, fix_t dy, fix_t r, const CRGB& c) {
+  uint32_t d = isqrt((uint32_t)(dx * dx + dy * dy) << (16 - 2 * RASTER_FRAC_BITS));
+  int32_t inside = ((r << (8 - RASTER_FRAC_BITS)) + 128) - (int32_t)d;
+  if (inside <= 0)
+    return;
+  compositor.blendPixel(layer, x, y, c, inside > 255 ? 255 : inside);
+}
+
+// The radius of the disc is r plus half a pixel. Pixels whose centre is half a
+// pixel inside of that are written as a span, only the ring around the edge
+// needs a square root per pixel.
+void Rasterizer::fillCircleAA(fix_t cx, fix_t cy, fix_t r, const CRGB& c) {
+  if (r < 0 || !(c.r | c.g | c.b))
+    return;
+  if (r > MAX_AA_RADIUS) {
+    fillCircle(cx, cy, r, c);
+    return;
+  }
+
+  const fix_t radius = r + HALF;
+  const int32_t outer2 = (radius + HALF) * (radius + HALF);
+  const int32_t inner2 = r * r;  // radius less half a pixel
+
+  int32_t y_first = max(floorPixel(cy - radius - HALF), (int32_t)0);
+  int32_t y_last = min(floorPixel(cy + radius + HALF), (int32_t)255);
+  for (int32_t y = y_first; y <= y_last; y++) {
+    fix_t dy = (y << RASTER_FRAC_BITS) + HALF - cy;
+    int32_t dy2 = dy * dy;
+    if (dy2 >= outer2)
+      continue;
+
+    // Pixels with their centre less than half a pixel outside the edge
+    fix_t outer_hw = isqrt(outer2 - dy2);
+    int32_t x_first = max(floorPixel(cx - outer_hw - HALF), (int32_t)0);
+    int32_t x_last = min(floorPixel(cx + outer_hw - HALF), (int32_t)255);
+
+    // Pixels entirely inside
+    int32_t full_first = x_last + 1;
+    int32_t full_last = x_last;
+    if (dy2 < inner2) {
+      fix_t inner_hw = isqrt(inner2 - dy2);
+      full_first = -floorPixel(HALF + inner_hw - cx);
+      full_last = floorPixel(cx + inner_hw - HALF);
+    }
+
+    for (int32_t x = x_first; x <= x_last && x < full_first; x++) {
+      blendEdge(x, y, (x << RASTER_FRAC_BITS) + HALF - cx, dy, radius, c);
+    }
+    if (full_first <= full_last) {
+      compositor.fillSpan(layer, y, full_first, full_last, c);
+    }
+    for (int32_t x = max(full_last + 1, x_first); x <= x_last; x++) {
+      blendEdge(x, y, (x << RASTER_FRAC_BITS) + HALF - cx, dy, radius, c);
+    }
+  }
+}
+
+// Xiaolin Wu's line: per column along the major axis, the two pixels nearest
+// the line share it by distance. The end columns are weighted by how much of
+// them the line spans, so consecutive segments join without a bright knot.
+void Rasterizer::drawLineAA(fix_t x0, fix_t y0, fix_t x1, fix_t y1, const CRGB& c) {
+  if (!(c.r | c.g | c.b))
+    return;
+
+  // Pixel centres on whole pixels from here
+  x0 -= HALF;
+  y0 -= HALF;
+  x1 -= HALF;
+  y1 -= HALF;
+
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  fix_t dx = x1 - x0;
+  // 16.16 pixels per pixel along the major axis, at most 1
+  int32_t gradient = dx ? (int32_t)((int64_t)(y1 - y0) * 65536 / dx) : 0;
+
+  int32_t first = floorPixel(x0 + HALF);  // nearest column
+  int32_t last = floorPixel(x1 + HALF);
+  int32_t i = max(first, (int32_t)0);
+  int32_t end = min(last, (int32_t)255);
+
+  // Minor axis position where the line crosses column i, 16.16
+  int32_t pos = y0 * (1 << (16 - RASTER_FRAC_BITS)) +
+                (int32_t)(((int64_t)gradient * ((i << RASTER_FRAC_BITS) - x0)) >> RASTER_FRAC_BITS);
+
+  for (; i <= end; i++, pos += gradient) {
+    // Share of the column the line spans, in 1/256
+    uint16_t span = 256;
+    if (first != last) {
+      if (i == first)
+        span = ((first << RASTER_FRAC_BITS) + HALF - x0) << (8 - RASTER_FRAC_BITS);
+      else if (i == last)
+        span = (x1 - (last << RASTER_FRAC_BITS) + HALF) << (8 - RASTER_FRAC_BITS);
+    }
+
+    int16_t minor = pos >> 16;
+    uint8_t frac = (pos >> 8) & 0xFF;
+    uint8_t near = ((255 - frac) * span) >> 8;
+    uint8_t far = (frac * span) >> 8;
+    if (steep) {
+      compositor.blendPixel(layer, minor, i, c, near);
+      compositor.blendPixel(layer, minor + 1, i, c, far);
+    } else {
+      compositor.blendPixel(layer, i, minor, c, near);
+      compositor.blendPixel(layer, i, minor + 1, c, far);
+    }
+  }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "LayerCompositor.hpp"
+
+// Coordinates in 1/16 pixel
+typedef int32_t fix_t;
+#define RASTER_FRAC_BITS 4
+
+inline fix_t toFixed(float v) {
+  return (fix_t)(v * (1 << RASTER_FRAC_BITS));
+}
+
+// Circles and lines as horizontal spans, written straight into a compositor
+// layer with LayerCompositor::fillSpan() instead of pixel by pixel through
+// GFX_Layer. The pixels are the ones GFX_Layer's fillCircle() / drawLine()
+// would set for the same coordinates (truncated to whole pixels), so shapes
+// can move over from the GFX layers without looking any different.
+//
+// The AA variants place shapes at the sub-pixel position instead and blend
+// the edge pixels by how much of them the shape covers, see LayerCompositor::
+// blendPixel(), so shapes glide rather than step from pixel to pixel.
+//
+// Cheap to make, see Matrix::raster().
+class Rasterizer {
+ public:
+  Rasterizer(LayerCompositor& compositor, LayerId layer)
+      : compositor(compositor), layer(layer) {}
+
+  void fillCircle(fix_t cx, fix_t cy, fix_t r, const CRGB& c);
+  void drawLine(fix_t x0, fix_t y0, fix_t x1, fix_t y1, const CRGB& c);
+
+  // Disc reaching half a pixel past r, about the size fillCircle() draws
+  void fillCircleAA(fix_t cx, fix_t cy, fix_t r, const CRGB& c);
+  // One pixel wide, Wu's algorithm
+  void drawLineAA(fix_t x0, fix_t y0, fix_t x1, fix_t y1, const CRGB& c);
+
+  // Half width of each row of a filled circle, rows 0 (centre) to r
+  static const uint8_t* circleSpans(int16_t r);
+
+ private:
+  // Whole pixels, truncated towards zero as a float -> int16_t cast does
+  static inline int16_t pixel(fix_t v) { return v / (1 << RASTER_FRAC_BITS); }
+  // Whole pixels, rounded down
+  static inline int32_t floorPixel(fix_t v) { return v >> RASTER_FRAC_BITS; }
+
+  static constexpr int16_t MAX_TABLE_RADIUS = 31;
+  static void buildSpans(int16_t r, uint8_t* half_widths);
+
+  // Larger discs would overflow the distance maths, and are drawn as fillCircle()
+  static constexpr fix_t MAX_AA_RADIUS = 64 << RASTER_FRAC_BITS;
+  void blendEdge(int16_t x, int16_t y, fix_t dx, fix_t dy, fix_t r, const CRGB& c);
+
+  LayerCompositor& compositor;
+  LayerId layer;
+};
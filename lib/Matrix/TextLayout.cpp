@@ -0,0 +1,239 @@
+#include "TextLayout.hpp"
+
+const GlyphAtlas& GlyphAtlas::of(const GFXfont* font) {
+  static GlyphAtlas* atlases[MAX_FONTS];
+  static uint8_t count = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (atlases[i]->font == font) {
+      return *atlases[i];
+    }
+  }
+  assert(count < MAX_FONTS);
+  atlases[count] = new GlyphAtlas(font);
+  return *atlases[count++];
+}
+
+// Glyph bitmaps are packed, rows running on into each other MSB first. The
+// fonts here are at most 6 pixels wide, anything past 32 would be cut off.
+GlyphAtlas::GlyphAtlas(const GFXfont* font)
+    : font(font), first(font->first), last(font->last), y_advance(font->yAdvance) {
+  const GFXglyph* source = font->glyph;
+  const uint8_t* bitmap = font->bitmap;
+  uint16_t count = last - first + 1;
+
+  uint16_t total_rows = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    total_rows += source[i].height;
+  }
+  glyphs = new Glyph[count];
+  rows = new uint32_t[total_rows]();
+  assert(glyphs != nullptr && rows != nullptr);
+
+  uint16_t row = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    const GFXglyph& g = source[i];
+    glyphs[i] = {row, g.width, g.height, g.xOffset, g.yOffset, g.xAdvance};
+
+    uint16_t offset = g.bitmapOffset;
+    uint8_t bits = 0;
+    uint8_t bit = 0;
+    for (uint8_t y = 0; y < g.height; y++) {
+      for (uint8_t x = 0; x < g.width; x++) {
+        if (!(bit++ & 7)) {
+          bits = bitmap[offset++];
+        }
+        if ((bits & 0x80) && x < 32) {
+          rows[row + y] |= 1UL << x;
+        }
+        bits <<= 1;
+      }
+    }
+    row += g.height;
+  }
+
+  log_d("Glyph atlas: %u glyphs, %u rows", count, total_rows);
+}
+
+bool TextLayout::unchanged(const char* text, const Placement& p) {
+  if (laid_out && p == placement && this->text == text) {
+    return true;
+  }
+  this->text = text;
+  placement = p;
+  laid_out = true;
+  runs.clear();
+  bounds = LayerRect();
+  return false;
+}
+
+void TextLayout::add(const GlyphAtlas::Glyph* glyph, int16_t x, int16_t baseline) {
+  Run run = {glyph, (int16_t)(x + glyph->x_offset), (int16_t)(baseline + glyph->y_offset)};
+  runs.push_back(run);
+  bounds.add(run.x, run.y);
+  bounds.add(run.x + glyph->width - 1, run.y + glyph->height - 1);
+}
+
+// Same sums as Adafruit GFX's charBounds(), zero width glyphs included
+LayerRect TextLayout::measure(const GlyphAtlas& atlas, const char* text, size_t length) {
+  int16_t min_x = INT16_MAX, min_y = INT16_MAX, max_x = -1, max_y = -1;
+  int16_t x = 0;
+  for (size_t i = 0; i < length; i++) {
+    const GlyphAtlas::Glyph* g = atlas.glyph(text[i]);
+    if (g == nullptr)
+      continue;
+    int16_t x1 = x + g->x_offset;
+    int16_t y1 = g->y_offset;
+    min_x = min(min_x, x1);
+    min_y = min(min_y, y1);
+    max_x = max(max_x, (int16_t)(x1 + g->width - 1));
+    max_y = max(max_y, (int16_t)(y1 + g->height - 1));
+    x += g->x_advance;
+  }
+
+  LayerRect box;
+  box.x0 = min_x;
+  box.y0 = min_y;
+  box.x1 = max_x;
+  box.y1 = max_y;
+  return box;
+}
+
+// The layout Aquarium's text always had: the block is as high as its lines'
+// bounds add up to, and starts one (last) line height down from where it is
+// placed, each line is aligned by its own bounds
+bool TextLayout::set(const char* text, const GFXfont* font, textPosition position,
+                     TextAlign align, uint16_t width, uint16_t height) {
+  Placement p;
+  p.font = font;
+  p.position = position;
+  p.align = align;
+  p.width = width;
+  p.height = height;
+  if (unchanged(text, p))
+    return false;
+  atlas = &GlyphAtlas::of(font);
+
+  auto lineWidth = [](const LayerRect& box) { return box.x1 >= box.x0 ? box.x1 - box.x0 + 1 : 0; };
+  auto lineHeight = [](const LayerRect& box) { return box.y1 >= box.y0 ? box.y1 - box.y0 + 1 : 0; };
+
+  int16_t total = 0;
+  int16_t last_height = 0;
+  for (const char* line = text; *line;) {
+    size_t length = strcspn(line, "\n");
+    last_height = lineHeight(measure(*atlas, line, length));
+    total += last_height;
+    line += length;
+    if (*line == '\n')
+      line++;
+  }
+
+  int16_t baseline;
+  if (position == TOP) {
+    baseline = last_height;
+  } else if (position == BOTTOM) {
+    baseline = height - total;
+  } else {  // MIDDLE
+    baseline = (height - total) / 2 + last_height;
+  }
+
+  for (const char* line = text; *line;) {
+    size_t length = strcspn(line, "\n");
+    LayerRect box = measure(*atlas, line, length);
+
+    int16_t x;
+    switch (align) {
+      case TextAlign::CENTER:
+        x = (width - lineWidth(box)) / 2;
+        break;
+      case TextAlign::RIGHT:
+        x = width - lineWidth(box);
+        break;
+      default:
+        x = 0;
+        break;
+    }
+    for (size_t i = 0; i < length; i++) {
+      const GlyphAtlas::Glyph* g = atlas->glyph(line[i]);
+      if (g == nullptr)
+        continue;
+      if (g->width && g->height) {
+        add(g, x, baseline);
+      }
+      x += g->x_advance;
+    }
+
+    baseline += lineHeight(box);
+    line += length;
+    if (*line == '\n')
+      line++;
+  }
+  return true;
+}
+
+bool TextLayout::setAt(const char* text, const GFXfont* font, int16_t x, int16_t y,
+                       uint16_t width) {
+  Placement p;
+  p.font = font;
+  p.at = true;
+  p.x = x;
+  p.y = y;
+  p.width = width;
+  if (unchanged(text, p))
+    return false;
+  atlas = &GlyphAtlas::of(font);
+
+  for (const char* c = text; *c; c++) {
+    if (*c == '\n') {
+      x = 0;
+      y += atlas->lineAdvance();
+      continue;
+    }
+    const GlyphAtlas::Glyph* g = atlas->glyph(*c);
+    if (g == nullptr)
+      continue;
+    if (g->width && g->height) {
+      if (x + g->x_offset + g->width > width) {
+        x = 0;
+        y += atlas->lineAdvance();
+      }
+      add(g, x, y);
+    }
+    x += g->x_advance;
+  }
+  return true;
+}
+
+void TextLayout::drawColumns(uint32_t* columns, int16_t x0, int16_t y0, size_t count) const {
+  for (const Run& run : runs) {
+    const uint32_t* rows = atlas->rowsOf(*run.glyph);
+    for (uint8_t r = 0; r < run.glyph->height; r++) {
+      int16_t bit = run.y + r - y0;
+      if (bit < 0 || bit >= 32)
+        continue;
+      for (uint32_t bits = rows[r]; bits; bits &= bits - 1) {
+        int32_t x = run.x + __builtin_ctz(bits) - x0;
+        if (x >= 0 && (size_t)x < count) {
+          columns[x] |= 1UL << bit;
+        }
+      }
+    }
+  }
+}
+
+// Each glyph row is a word: its runs of set bits are spans
+void TextLayout::draw(LayerCompositor& compositor, LayerId layer, const CRGB& color) const {
+  for (const Run& run : runs) {
+    const uint32_t* rows = atlas->rowsOf(*run.glyph);
+    for (uint8_t r = 0; r < run.glyph->height; r++) {
+      uint32_t bits = rows[r];
+      while (bits) {
+        uint8_t start = __builtin_ctz(bits);
+        uint32_t rest = bits >> start;
+        uint8_t length = ~rest ? __builtin_ctz(~rest) : 32 - start;
+        compositor.fillSpan(layer, run.y + r, run.x + start, run.x + start + length - 1, color);
+        bits &= start + length >= 32 ? 0 : 0xFFFFFFFFu << (start + length);
+      }
+    }
+  }
+}
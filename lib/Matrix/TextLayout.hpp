@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "GFX_Layer.hpp"
+#include "LayerCompositor.hpp"
+
+enum class TextAlign : uint8_t { LEFT, CENTER, RIGHT };
+
+// A GFXfont's glyphs expanded once into one word per glyph row, bit n being
+// pixel n from the left, so a row goes onto a layer as a few spans instead of
+// bit by bit out of the packed font bitmap.
+class GlyphAtlas {
+ public:
+  struct Glyph {
+    uint16_t row;  // first of its rows in the atlas
+    uint8_t width;
+    uint8_t height;
+    int8_t x_offset;
+    int8_t y_offset;
+    uint8_t x_advance;
+  };
+
+  // Built on first use and kept, there are only a few fonts
+  static const GlyphAtlas& of(const GFXfont* font);
+
+  // nullptr if the font doesn't have c
+  const Glyph* glyph(char c) const {
+    uint8_t code = c;
+    return code >= first && code <= last ? &glyphs[code - first] : nullptr;
+  }
+  const uint32_t* rowsOf(const Glyph& g) const { return &rows[g.row]; }
+  uint8_t lineAdvance() const { return y_advance; }
+
+ private:
+  explicit GlyphAtlas(const GFXfont* font);
+
+  static constexpr uint8_t MAX_FONTS = 8;
+
+  const GFXfont* font;
+  uint8_t first;
+  uint8_t last;
+  uint8_t y_advance;
+  Glyph* glyphs;
+  uint32_t* rows;
+};
+
+// Text laid out into glyph runs, positions of atlas glyphs, and kept until the
+// text or its placement changes. Drawing the same text again only blits the
+// runs: no splitting, no bounds, no walking the font bitmap.
+class TextLayout {
+ public:
+  // Lines split at '\n', each aligned within width, the block placed at the
+  // top, middle or bottom of height. Returns false, keeping the runs, if that
+  // is what is laid out already.
+  bool set(const char* text, const GFXfont* font, textPosition position, TextAlign align,
+           uint16_t width, uint16_t height);
+
+  // As GFX print() from the cursor at x, y (the baseline): wrapping at width,
+  // '\n' going back to x = 0
+  bool setAt(const char* text, const GFXfont* font, int16_t x, int16_t y, uint16_t width);
+
+  void draw(LayerCompositor& compositor, LayerId layer, const CRGB& color) const;
+
+  // Into count 1-bit columns starting at x0: bit n of columns[i] is pixel
+  // x0 + i, y0 + n. Rows past 32 are left out.
+  void drawColumns(uint32_t* columns, int16_t x0, int16_t y0, size_t count) const;
+
+  // Pixels the glyphs cover
+  const LayerRect& getBounds() const { return bounds; }
+  size_t glyphCount() const { return runs.size(); }
+
+ private:
+  struct Run {
+    const GlyphAtlas::Glyph* glyph;
+    int16_t x;  // top left of the glyph
+    int16_t y;
+  };
+
+  // What the runs were laid out from, besides the text
+  struct Placement {
+    const GFXfont* font = nullptr;
+    bool at = false;
+    uint8_t position = 0;
+    TextAlign align = TextAlign::LEFT;
+    int16_t x = 0;
+    int16_t y = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    bool operator==(const Placement& p) const {
+      return font == p.font && at == p.at && position == p.position && align == p.align &&
+             x == p.x && y == p.y && width == p.width && height == p.height;
+    }
+  };
+
+  bool unchanged(const char* text, const Placement& placement);
+  void add(const GlyphAtlas::Glyph* glyph, int16_t x, int16_t baseline);
+  // One line's bounds from 0, 0, as GFX getTextBounds() has them
+  static LayerRect measure(const GlyphAtlas& atlas, const char* text, size_t length);
+
+  String text;
+  Placement placement;
+  bool laid_out = false;
+  const GlyphAtlas* atlas = nullptr;
+
+  std::vector<Run> runs;  // keeps its capacity from one layout to the next
+  LayerRect bounds;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "GFX_Layer.hpp"
+
+// GFX_Layer whose clear() only blanks what display() last sent, instead of the
+// whole layer. display() hands every pixel that isn't transparent to the
+// callback, so the bounds are gathered there; transparent pixels are blank
+// already. Meant for layers that are drawn, displayed and cleared every frame,
+// like the aquarium's fish: anything drawn after display() and before clear()
+// is left behind. With nothing displayed since the last clear() the whole
+// layer is cleared, as GFX_Layer would.
+class TrackedLayer : public GFX_Layer {
+ public:
+  using Callback = std::function<void(int16_t, int16_t, uint8_t, uint8_t, uint8_t)>;
+
+  TrackedLayer(uint16_t width, uint16_t height, Callback callback)
+      : GFX_Layer(width, height,
+                  [this, callback](int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+                    x0 = std::min(x0, x);
+                    y0 = std::min(y0, y);
+                    x1 = std::max(x1, x);
+                    y1 = std::max(y1, y);
+                    callback(x, y, r, g, b);
+                  }) {}
+
+  void clear() {
+    if (x1 < x0) {
+      GFX_Layer::clear();
+      return;
+    }
+    const CRGB blank(0, 0, 0);
+    for (int16_t y = y0; y <= y1; y++) {
+      for (int16_t x = x0; x <= x1; x++) {
+        drawPixel(x, y, blank);
+      }
+    }
+    x0 = y0 = INT16_MAX;
+    x1 = y1 = -1;
+  }
+
+ private:
+  // Inclusive, empty while x1 < x0
+  int16_t x0 = INT16_MAX;
+  int16_t y0 = INT16_MAX;
+  int16_t x1 = -1;
+  int16_t y1 = -1;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+// Lock-free hand over of frames from one producer task to one consumer task.
+// Three slots: the producer owns one to draw into, the consumer owns one to read
+// from, and the third holds the newest finished frame. Neither side ever waits;
+// if the consumer falls behind, older frames are simply replaced.
+class TripleBuffer {
+ public:
+  // Producer: slot to draw into
+  uint8_t writeSlot() const { return back; }
+
+  // Producer: hand over the slot just drawn, returns the slot to draw into next.
+  // replaced is set if the consumer never took the frame handed over before.
+  uint8_t publish(bool* replaced = nullptr) {
+    uint8_t old = middle.exchange(back | FRESH);
+    if (replaced) {
+      *replaced = old & FRESH;
+    }
+    back = old & INDEX;
+    return back;
+  }
+
+  // Consumer: take the newest finished frame, false if there is none since
+  // the last call
+  bool consume() {
+    if (!(middle.load() & FRESH)) {
+      return false;
+    }
+    front = middle.exchange(front) & INDEX;
+    return true;
+  }
+
+  // Consumer: slot taken by the last successful consume()
+  uint8_t readSlot() const { return front; }
+
+ private:
+  static constexpr uint8_t INDEX = 0x03;
+  static constexpr uint8_t FRESH = 0x04;
+
+  uint8_t back = 0;
+  std::atomic<uint8_t> middle{1};
+  uint8_t front = 2;
+};
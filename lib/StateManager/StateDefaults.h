@@ -30,6 +30,7 @@
 // Text Defaults
 #define DEFAULT_TEXT_PAYLOAD "Hello, World!"
 #define DEFAULT_TEXT_SIZE TextSize::MEDIUM
+#define DEFAULT_TEXT_SPEED 0
 
 // MQTT Defaults
 #define DEFAULT_MQTT_STATUS ConnectionStatus::DISCONNECTED
@@ -63,4 +64,7 @@
 // Calibration defaults
 #define DEFAULT_CAL_TEMP_OFFSET_C 0.0f
 #define DEFAULT_CAL_HUMIDITY_OFFSET_PCT 0.0f
-#define DEFAULT_CAL_CO2_OFFSET_PPM 0
\ No newline at end of file
+#define DEFAULT_CAL_CO2_OFFSET_PPM 0
+
+// White balance defaults, per channel gain, 255 = unity
+#define DEFAULT_WHITE_BALANCE_GAIN 255
\ No newline at end of file
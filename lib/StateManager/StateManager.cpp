@@ -79,6 +79,7 @@ void StateManager::serialize(String& buffer, bool settings_only) {
   // Text
   json["text"]["payload"] = _state.text.payload;
   json["text"]["size"] = _state.text.size;
+  json["text"]["speed"] = _state.text.speed;
 
   // Settings
   JsonObject settings = json["settings"].to<JsonObject>();
@@ -86,6 +87,10 @@ void StateManager::serialize(String& buffer, bool settings_only) {
   settings["calibration"]["temperatureOffsetC"] = _state.settings.calibration.temperatureOffsetC;
   settings["calibration"]["humidityOffsetPct"] = _state.settings.calibration.humidityOffsetPct;
   settings["calibration"]["co2OffsetPpm"] = _state.settings.calibration.co2OffsetPpm;
+  // White balance
+  settings["whiteBalance"]["r"] = _state.settings.whiteBalance.r;
+  settings["whiteBalance"]["g"] = _state.settings.whiteBalance.g;
+  settings["whiteBalance"]["b"] = _state.settings.whiteBalance.b;
   // MQTT
   settings["mqtt"]["status"] = _state.settings.mqtt.status;
   settings["mqtt"]["host"] = _state.settings.mqtt.host;
@@ -225,8 +230,10 @@ void StateManager::restore() {
   // Text
   _state.text.payload = json["text"]["payload"] | DEFAULT_TEXT_PAYLOAD;
   _state.text.size = json["text"]["size"] | DEFAULT_TEXT_SIZE;
+  _state.text.speed = json["text"]["speed"] | DEFAULT_TEXT_SPEED;
   log_i("Restored text payload: %s", _state.text.payload);
   log_i("Restored text size: %d", static_cast<int>(_state.text.size));
+  log_i("Restored text speed: %d", _state.text.speed);
 
   // Settings
   JsonObject settings = json["settings"];
@@ -258,6 +265,11 @@ void StateManager::restore() {
   _state.settings.calibration.humidityOffsetPct = settings["calibration"]["humidityOffsetPct"] | DEFAULT_CAL_HUMIDITY_OFFSET_PCT;
   _state.settings.calibration.co2OffsetPpm = settings["calibration"]["co2OffsetPpm"] | DEFAULT_CAL_CO2_OFFSET_PPM;
 
+  // White balance
+  _state.settings.whiteBalance.r = settings["whiteBalance"]["r"] | DEFAULT_WHITE_BALANCE_GAIN;
+  _state.settings.whiteBalance.g = settings["whiteBalance"]["g"] | DEFAULT_WHITE_BALANCE_GAIN;
+  _state.settings.whiteBalance.b = settings["whiteBalance"]["b"] | DEFAULT_WHITE_BALANCE_GAIN;
+
   // Scheduler
   _state.settings.scheduler.enableDarkAutoPower = settings["scheduler"]["enableDarkAutoPower"] | DEFAULT_SCHED_ENABLE_DARK;
   _state.settings.scheduler.darkThresholdLux = settings["scheduler"]["darkThresholdLux"] | DEFAULT_SCHED_DARK_THRESHOLD_LUX;
@@ -309,6 +321,7 @@ void StateManager::setDefaultState() {
     #endif
     _state.text.payload = DEFAULT_TEXT_PAYLOAD;
     _state.text.size = DEFAULT_TEXT_SIZE;
+    _state.text.speed = DEFAULT_TEXT_SPEED;
 
     // Settings
     // MQTT
@@ -339,6 +352,11 @@ void StateManager::setDefaultState() {
     _state.settings.calibration.humidityOffsetPct = DEFAULT_CAL_HUMIDITY_OFFSET_PCT;
     _state.settings.calibration.co2OffsetPpm = DEFAULT_CAL_CO2_OFFSET_PPM;
 
+    // White balance
+    _state.settings.whiteBalance.r = DEFAULT_WHITE_BALANCE_GAIN;
+    _state.settings.whiteBalance.g = DEFAULT_WHITE_BALANCE_GAIN;
+    _state.settings.whiteBalance.b = DEFAULT_WHITE_BALANCE_GAIN;
+
     // Scheduler
     _state.settings.scheduler.enableDarkAutoPower = DEFAULT_SCHED_ENABLE_DARK;
     _state.settings.scheduler.darkThresholdLux = DEFAULT_SCHED_DARK_THRESHOLD_LUX;
@@ -130,6 +130,7 @@ struct State {
     struct {
         String payload;
         TextSize size = SMALL;
+        uint8_t speed = 0;  // marquee, pixels per second, 0 = still
     } text;
 
     // Settings
@@ -139,6 +140,11 @@ struct State {
             float humidityOffsetPct = 0.0f;
             int16_t co2OffsetPpm = 0;
         } calibration;
+        struct {
+            uint8_t r = 255;  // per channel gain, 255 = unity
+            uint8_t g = 255;
+            uint8_t b = 255;
+        } whiteBalance;
         struct {
             ConnectionStatus status = DISCONNECTED;
             String host;
@@ -6,18 +6,51 @@
 #include <Fonts/Font5x7Fixed.h>
 #include <Matrix.h>
 
+#include <vector>
+
 class TextDraw {
  public:
   TextDraw(Matrix* matrix);
+  // Forget what is on the panel, the next drawText() draws again
   void reset();
-  void drawText(String text);
+  // Returns false, without drawing, if the panel already shows this text
+  bool drawText(const String& text);
   void setSize(uint8_t size);
   void setColor(CRGB color);
+  // Scroll the text right to left at speed pixels per second, 0 shows it still
+  void setSpeed(uint8_t speed);
+  // Blend neighbouring columns by the sub-pixel scroll offset, otherwise the
+  // marquee steps whole pixels
+  void setBlend(bool blend);
 
  private:
   Matrix* matrix;
   uint8_t size;
   CRGB color;
+  const GFXfont* font = &Font5x5Fixed;
+  int16_t baseline = 5;
+
+  // Laid out again only when the text or size changes, otherwise drawing is
+  // a blit of the cached glyphs into the background layer
+  TextLayout layout;
+
+  // Marquee: the text rendered once into 1-bit columns, bit n being row
+  // strip_top + n, followed by a panel's width of gap. Each frame shows a
+  // panel wide window of it, so the cost doesn't grow with the text.
+  uint8_t speed = 0;
+  bool blend = true;
+  std::vector<uint32_t> strip;
+  int16_t strip_top = 0;
+  uint32_t scroll = 0;  // window start, 1/256 columns into the strip
+  unsigned long last_scroll = 0;
+  bool drawMarquee(const String& text);
+
+  // What the last drawText() put on the panel
+  bool drawn = false;
+  String drawnText;
+  uint8_t drawnSize;
+  CRGB drawnColor;
+  uint32_t drawnGeneration;
 };
 
 TextDraw::TextDraw(Matrix* matrix) {
@@ -26,21 +59,77 @@ TextDraw::TextDraw(Matrix* matrix) {
   this->color = CRGB(255, 255, 255);
 }
 
-void TextDraw::drawText(String text) {
-  matrix->background->clear();
-  switch (size) {
-    case 0:
-      matrix->background->setCursor(0,5);
-      break;
-    case 1:
-      matrix->background->setCursor(0,5);
-      break;
-    case 2:
-      matrix->background->setCursor(0,7);
-      break;
+void TextDraw::reset() {
+  drawn = false;
+}
+
+bool TextDraw::drawText(const String& text) {
+  if (speed) {
+    return drawMarquee(text);
+  }
+  if (drawn && text == drawnText && size == drawnSize && color == drawnColor &&
+      matrix->getContentGeneration() == drawnGeneration) {
+    return false;
+  }
+
+  layout.setAt(text.c_str(), font, 0, baseline, matrix->getXResolution());
+  layout.draw(matrix->compositor, LAYER_BACKGROUND, color);
+
+  drawn = true;
+  drawnText = text;
+  drawnSize = size;
+  drawnColor = color;
+  drawnGeneration = matrix->getContentGeneration();
+  return true;
+}
+
+bool TextDraw::drawMarquee(const String& text) {
+  const uint16_t width = matrix->getXResolution();
+  bool relaid = layout.setAt(text.c_str(), font, 0, baseline, UINT16_MAX);
+  if (relaid || strip.empty()) {
+    const LayerRect& bounds = layout.getBounds();
+    size_t length = bounds.empty() ? 0 : bounds.x1 + 1;
+    strip_top = bounds.y0;
+    strip.assign(length + width, 0);
+    layout.drawColumns(strip.data(), 0, strip_top, length);
+    scroll = length << 8;  // the gap first, the text comes in from the right
+  }
+
+  // Moves with the time passed, so a slow frame doesn't slow the text down
+  unsigned long now = millis();
+  uint32_t elapsed = drawn ? min(now - last_scroll, 1000UL) : 0;
+  last_scroll = now;
+  uint32_t previous = scroll;
+  scroll = (scroll + speed * elapsed * 256 / 1000) % (strip.size() << 8);
+
+  bool moved = blend ? scroll != previous : (scroll >> 8) != (previous >> 8);
+  if (drawn && !relaid && !moved && color == drawnColor &&
+      matrix->getContentGeneration() == drawnGeneration) {
+    return false;
   }
-  matrix->background->print(text);
-  matrix->background->display();
+
+  uint32_t column = scroll >> 8;
+  uint16_t frac = blend ? scroll & 0xFF : 0;
+  for (uint16_t x = 0; x < width; x++) {
+    uint32_t left = strip[column];
+    if (++column == strip.size())
+      column = 0;
+    uint32_t right = frac ? strip[column] : 0;
+
+    for (uint32_t bits = left | right; bits; bits &= bits - 1) {
+      uint8_t row = __builtin_ctz(bits);
+      uint16_t weight = ((left >> row) & 1 ? 256 - frac : 0) + ((right >> row) & 1 ? frac : 0);
+      matrix->compositor.writePixel(LAYER_BACKGROUND, x, strip_top + row, color.r * weight >> 8,
+                                    color.g * weight >> 8, color.b * weight >> 8);
+    }
+  }
+
+  drawn = true;
+  drawnText = text;
+  drawnSize = size;
+  drawnColor = color;
+  drawnGeneration = matrix->getContentGeneration();
+  return true;
 }
 
 void TextDraw::setSize(uint8_t size) {
@@ -55,13 +144,16 @@ void TextDraw::setSize(uint8_t size) {
     this->size = size;
     switch (size) {
       case 0:
-        matrix->background->setFont(&Font4x5Fixed);
+        font = &Font4x5Fixed;
+        baseline = 5;
         break;
       case 1:
-        matrix->background->setFont(&Font5x5Fixed);
+        font = &Font5x5Fixed;
+        baseline = 5;
         break;
       case 2:
-        matrix->background->setFont(&Font5x7Fixed);
+        font = &Font5x7Fixed;
+        baseline = 7;
         break;
     }
   }
@@ -69,4 +161,15 @@ void TextDraw::setSize(uint8_t size) {
 
 void TextDraw::setColor(CRGB color) {
   this->color = color;
-}
\ No newline at end of file
+}
+
+void TextDraw::setSpeed(uint8_t speed) {
+  if (speed != this->speed) {
+    this->speed = speed;
+    drawn = false;
+  }
+}
+
+void TextDraw::setBlend(bool blend) {
+  this->blend = blend;
+}
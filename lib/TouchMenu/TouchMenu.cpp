@@ -173,7 +173,7 @@ void TouchMenu::displayMenu() {
     }
   }
 
-  matrix->background->display();
+  matrix->displayInto(matrix->background, LAYER_OVERLAY);
 
   if (optionSelected) {
     if (confirmationRequired) {
@@ -323,7 +323,8 @@ void UI::begin() {
     if (err == DeserializationError::Ok) {
       if (_on_text_cb) {
         _on_text_cb(json["payload"].as<const char*>(),
-                    json["size"].as<TextSize>());
+                    json["size"].as<TextSize>(),
+                    json["speed"] | (uint8_t)0);
         log_i("Text changed: %s", json["payload"].as<const char*>());
       }
       return _server->send(200, "application/json", ok_response);
@@ -436,6 +437,26 @@ void UI::begin() {
       return _server->send(400, "application/json", invalid_response);
     }
   });
+
+  // on white balance settings
+  _server->on("/openmatrix/settings/whitebalance", HTTP_POST, [&]() {
+    JsonDocument json;
+    DeserializationError err = deserializeJson(json, _server->arg("plain"));
+    if (err == DeserializationError::Ok) {
+      if (_on_white_balance_settings_cb) {
+        _on_white_balance_settings_cb(
+          json["r"] | (uint8_t)DEFAULT_WHITE_BALANCE_GAIN,
+          json["g"] | (uint8_t)DEFAULT_WHITE_BALANCE_GAIN,
+          json["b"] | (uint8_t)DEFAULT_WHITE_BALANCE_GAIN
+        );
+        log_i("White balance settings updated.");
+      }
+      return _server->send(200, "application/json", ok_response);
+    } else {
+      log_e("Failed to deserialize White balance settings request.");
+      return _server->send(400, "application/json", invalid_response);
+    }
+  });
 }
 
 void UI::onPower(onPowerCallback cb) {
@@ -546,6 +567,10 @@ void UI::onCalibrationSettings(onCalibrationSettingsCallback cb) {
   _on_calibration_settings_cb = cb;
 }
 
+void UI::onWhiteBalanceSettings(onWhiteBalanceSettingsCallback cb) {
+  _on_white_balance_settings_cb = cb;
+}
+
 void UI::onNetworkReset(onResetCallback cb) {
   _on_network_reset_cb = cb;
 }
@@ -18,12 +18,13 @@ class UI {
         typedef std::function<void(Effects effect, JsonObject settings)> onEffectSettingsCallback;
         typedef std::function<void(const char* path)> onImageChangeCallback;
         typedef std::function<void(const char* path)> onImagePreviewCallback;
-        typedef std::function<void(const char* payload, TextSize size)> onTextChangeCallback;
+        typedef std::function<void(const char* payload, TextSize size, uint8_t speed)> onTextChangeCallback;
         typedef std::function<void(const char* host, uint16_t port, const char* client_id, const char* username, const char* password, const char* co2_topic, const char* matrix_text_topic, bool show_text)> onMqttSettingsCallback;
         typedef std::function<void(eDmxProtocol protocol, eDmxMode mode, bool multicast, uint16_t start_universe, uint16_t start_address, uint16_t timeout)> onDmxSettingsCallback;
         typedef std::function<void(bool show_text)> onHomeAssistantSettingsCallback;
         typedef std::function<void(bool enableDarkAutoPower, float darkThresholdLux, float darkHysteresisLux, uint16_t darkStabilitySeconds)> onSchedulerSettingsCallback;
         typedef std::function<void(float temperatureOffsetC, float humidityOffsetPct, int16_t co2OffsetPpm)> onCalibrationSettingsCallback;
+        typedef std::function<void(uint8_t r, uint8_t g, uint8_t b)> onWhiteBalanceSettingsCallback;
         typedef std::function<void()> onResetCallback;
 
         UI(WebServer* server, StateManager* stateManager);
@@ -41,6 +42,7 @@ class UI {
         void onHomeAssistantSettings(onHomeAssistantSettingsCallback cb);
         void onSchedulerSettings(onSchedulerSettingsCallback cb);
         void onCalibrationSettings(onCalibrationSettingsCallback cb);
+        void onWhiteBalanceSettings(onWhiteBalanceSettingsCallback cb);
         void onNetworkReset(onResetCallback cb);
         void onFactoryReset(onResetCallback cb);
         void handleImageUpload();
@@ -65,6 +67,7 @@ class UI {
         onHomeAssistantSettingsCallback _on_home_assistant_settings_cb;
         onSchedulerSettingsCallback _on_scheduler_settings_cb;
         onCalibrationSettingsCallback _on_calibration_settings_cb;
+        onWhiteBalanceSettingsCallback _on_white_balance_settings_cb;
         onResetCallback _on_network_reset_cb;
         onResetCallback _on_factory_reset_cb;
 
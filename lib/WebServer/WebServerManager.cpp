@@ -155,7 +155,9 @@ void WebServerManager::setupInterface() {
   
   interface.onEffectSettings([this](Effects effect, JsonObject settings) {
       log_i("Updating settings for effect: %d", static_cast<int>(effect));
-      // effectManager->updateEffectSettings(effect - 1, settings);
+      if (effect > NONE) {
+        effectManager->updateEffectSettings(effect - 1, settings);
+      }
       // stateManager->save();
   });
   
@@ -170,12 +172,13 @@ void WebServerManager::setupInterface() {
     }
   });
 
-  interface.onText([this](String payload, TextSize size) {
+  interface.onText([this](String payload, TextSize size, uint8_t speed) {
     stateManager->getState()->text.payload = payload;
     stateManager->getState()->text.size = size;
+    stateManager->getState()->text.speed = speed;
     stateManager->getState()->mode = OpenMatrixMode::TEXT;
     stateManager->save();
-    log_i("Text changed to: (%d) %s", size, payload.c_str());
+    log_i("Text changed to: (%d, %d px/s) %s", size, speed, payload.c_str());
   });
 
   interface.onMqttSettings([this](
@@ -261,6 +264,15 @@ void WebServerManager::setupInterface() {
     stateManager->save();
   });
 
+  // White balance settings
+  interface.onWhiteBalanceSettings([this](uint8_t r, uint8_t g, uint8_t b) {
+    stateManager->getState()->settings.whiteBalance.r = r;
+    stateManager->getState()->settings.whiteBalance.g = g;
+    stateManager->getState()->settings.whiteBalance.b = b;
+    stateManager->save();
+    matrix->setWhiteBalance(r, g, b);
+  });
+
   interface.onNetworkReset([this]() {
     log_i("[*] Resetting network");
     nw.reset();
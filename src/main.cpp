@@ -15,6 +15,10 @@
 
 #include <DebugMonitor.h>
 
+#ifdef RUN_BENCHMARKS
+#include <Benchmark.h>
+#endif
+
 #include <esp_task_wdt.h>
 #include <esp_err.h>
 
@@ -114,6 +118,8 @@ void displayTask(void* parameter) {
   uint8_t currentMode =
       99;  // make sure currentMode is not the same as OpenMatrixMode
   uint8_t lastAppliedBrightness = 255;
+  bool blankShown = false;  // powered off and the panel already cleared
+  uint32_t lastIdleFrames = 0;
 
   // Initialize components
   effectManager.setEffect(stateManager.getState()->effects.selected - 1);
@@ -127,7 +133,13 @@ void displayTask(void* parameter) {
 
     if (stateManager.getState()->power) {
       digitalWrite(2, LOW);
+      bool frameChanged = true;
+      if (blankShown) {
+        blankShown = false;
+        textDraw.reset();
+      }
       if (currentMode != stateManager.getState()->mode) {
+        textDraw.reset();
         if (currentMode == OpenMatrixMode::IMAGE) {
           imageDraw.closeGIF();
         }
@@ -142,7 +154,7 @@ void displayTask(void* parameter) {
             break;
           case OpenMatrixMode::TEXT:
             textDraw.setSize(stateManager.getState()->text.size);
-            textDraw.drawText(stateManager.getState()->text.payload);
+            textDraw.setSpeed(stateManager.getState()->text.speed);
             break;
         }
       }
@@ -158,20 +170,22 @@ void displayTask(void* parameter) {
 
       if (touchMenu.isMenuOpen()) {
         touchMenu.displayMenu();
+        textDraw.reset();  // drawn over
       } else {
         switch (stateManager.getState()->mode) {
           case OpenMatrixMode::EFFECT:
             effectManager.updateCurrentEffect();
-            matrix.background->display();
             break;
           case OpenMatrixMode::IMAGE:
             imageDraw.showGIF();
             matrix.background->display();
             break;
           case OpenMatrixMode::TEXT:
+            // Only redrawn when the text or the rotation changes, or while
+            // it scrolls
             textDraw.setSize(stateManager.getState()->text.size);
-            textDraw.drawText(stateManager.getState()->text.payload);
-            matrix.background->display();
+            textDraw.setSpeed(stateManager.getState()->text.speed);
+            frameChanged = textDraw.drawText(stateManager.getState()->text.payload);
             break;
           case OpenMatrixMode::AQUARIUM:
             aquarium.update(touchMenu.showSensorData());
@@ -190,17 +204,46 @@ void displayTask(void* parameter) {
         log_i("Refreshing Matrix Config");
         matrix.refreshMatrixConfig();
         lastRefreshTime = currentTime;
-      } else {
-        matrix.update();
       }
-#else
-      matrix.update();
 #endif
+      if (frameChanged) {
+        matrix.update();
+      } else {
+        matrix.holdFrame();
+      }
 
       frameCount++;
 
       if (millis() - lastLogTime >= MATRIX_REFRESH_INTERVAL) {
         float framerate = frameCount / ((currentTime - lastLogTime) / 1000.0);
+#ifdef PANEL_UPCYCLED
+        float seconds = (currentTime - lastLogTime) / 1000.0;
+        UMatrix::FrameStats stats = matrix.takeFrameStats();
+        uint32_t presented = stats.frames ? stats.frames : 1;
+        log_d("Framerate: %.1f FPS rendered, %.1f FPS presented (%s), %u dropped",
+              framerate, stats.frames / seconds,
+              matrix.isPipelined() ? "pipelined" : "serial", stats.dropped);
+        log_d("Latency: %llu us/frame, DMA wait: %lu us/frame",
+              stats.latency_us / presented, stats.wait_us / presented);
+        log_d("Scan lines: %.0f encoded/s, %.0f skipped/s, %u frames unchanged",
+              stats.encoded_rows / seconds,
+              (stats.frames * matrix.getScanLines() - stats.encoded_rows) / seconds,
+              stats.unchanged);
+#else
+        log_d("Framerate: %.1f FPS", framerate);
+#endif
+        uint32_t idleFrames = matrix.getIdleFrames() - lastIdleFrames;
+        log_d("Idle: %u of %lu frames held, nothing drawn or sent", idleFrames,
+              frameCount);
+        lastIdleFrames = matrix.getIdleFrames();
+        LayerCompositor::Stats layers = matrix.compositor.takeStats();
+        if (layers.frames) {
+          float total = (float)layers.frames * matrix.compositor.pixelCount();
+          log_d("Layers: %u of %u pixels/frame composited (%.0f%%), %u cleared (%.0f%%)",
+                layers.composited / layers.frames, matrix.compositor.pixelCount(),
+                layers.composited * 100.0f / total, layers.cleared / layers.frames,
+                layers.cleared * 100.0f / total);
+        }
         // TaskManager::getInstance().printTaskInfo();
         lastLogTime = currentTime;
         frameCount = 0;
@@ -217,8 +260,14 @@ void displayTask(void* parameter) {
     }
     else {
       digitalWrite(2, HIGH);
-      matrix.clearScreen();
-      matrix.update();
+      // One blank frame, then the panel is left alone until power comes back
+      if (!blankShown) {
+        matrix.clearScreen();
+        matrix.update();
+        blankShown = true;
+      } else {
+        matrix.holdFrame();
+      }
     }
 
     vTaskDelayUntil(&xLastWakeTime, xFrequency);
@@ -376,8 +425,22 @@ void setup(void) {
   pinMode(2, OUTPUT);
   digitalWrite(2, LOW);
 
+#if defined(PANEL_UPCYCLED) && defined(HIGH_REFRESH_SCAN)
+  MBI_ScanMode scanMode;
+  scanMode.gclk_multiplier = true;
+  scanMode.grey_13bit = true;
+  matrix.setScanMode(scanMode);
+#endif
   matrix.init();
 
+#ifdef RUN_BENCHMARKS
+  Benchmark::run(&matrix);
+#endif
+
+#if defined(PANEL_UPCYCLED) && defined(PIPELINED_DISPLAY)
+  matrix.setPipelined(true);
+#endif
+
   esp_task_wdt_config_t config = {
       .timeout_ms = 5000, // Set timeout to 5 seconds (5000 ms)
       .idle_core_mask = 0, // No specific core mask (0 means all cores)
@@ -417,6 +480,9 @@ void setup(void) {
   // Restore State
   stateManager.restore();
   matrix.setBrightness(stateManager.getState()->brightness);
+  matrix.setWhiteBalance(stateManager.getState()->settings.whiteBalance.r,
+                         stateManager.getState()->settings.whiteBalance.g,
+                         stateManager.getState()->settings.whiteBalance.b);
   // Start periodic save task
   stateManager.startPeriodicSave();
 
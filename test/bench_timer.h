@@ -0,0 +1,29 @@
+// Timing for the benchmark tests, on whatever host runs pio test -e native.
+// The numbers are only reported, they never pass or fail a test.
+
+#pragma once
+
+#include <unity.h>
+
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+// Microseconds fn() takes
+template <typename Fn>
+inline double benchUs(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// TEST_MESSAGE with printf formatting
+__attribute__((format(printf, 1, 2))) inline void benchReport(const char* format, ...) {
+  char message[160];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  TEST_MESSAGE(message);
+}
@@ -0,0 +1,121 @@
+// FastNoiseLite's GetNoiseRow() and GetNoiseGrid() against GetNoise() point
+// by point, for every noise and fractal type, 2D and 3D, into floats and Q15.
+// Sampling in batches may only change float rounding, well under one step of
+// an 8-bit brightness.
+
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "bench_timer.h"
+#include "Fastnoise.h"
+
+static const float TOLERANCE = 1.0f / 256;
+static const int W = 64;
+static const int H = 48;
+
+static const char* noiseNames[] = {"OpenSimplex2", "OpenSimplex2S", "Cellular",
+                                   "Perlin",       "ValueCubic",    "Value"};
+
+static FastNoiseLite makeNoise(int type, int fractal) {
+  FastNoiseLite noise(7);
+  noise.SetNoiseType((FastNoiseLite::NoiseType)type);
+  noise.SetFrequency(0.04f);
+  noise.SetFractalType((FastNoiseLite::FractalType)fractal);
+  noise.SetFractalWeightedStrength(0.3f);
+  return noise;
+}
+
+static void checkType(int fractal) {
+  std::vector<float> grid(W * H), row(W * 3);
+  std::vector<int16_t> fixed(W * H);
+  char message[96];
+
+  for (int type = 0; type < 6; type++) {
+    FastNoiseLite noise = makeNoise(type, fractal);
+    const float z = 123.4f;
+    float maxError = 0;
+
+    noise.GetNoiseGrid(grid.data(), W, H, W, 3.0f, 5.0f, z, 0.5f, 0.75f);
+    noise.GetNoiseGrid(fixed.data(), W, H, W, 3.0f, 5.0f, z, 0.5f, 0.75f);
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        float expected = noise.GetNoise(3.0f + x * 0.5f, 5.0f + y * 0.75f, z);
+        maxError = fmaxf(maxError, fabsf(grid[y * W + x] - expected));
+        maxError = fmaxf(maxError, fabsf(fixed[y * W + x] / 32767.0f - expected));
+      }
+    }
+
+    noise.GetNoiseGrid(grid.data(), W, H, W, -7.0f, 2.0f, 1.0f, 1.0f);
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        float expected = noise.GetNoise(-7.0f + x, 2.0f + y);
+        maxError = fmaxf(maxError, fabsf(grid[y * W + x] - expected));
+      }
+    }
+
+    // Strided, as the effects fill a column
+    noise.GetNoiseRow(row.data(), W, 3, 1.5f, -2.0f, 0.3f);
+    for (int i = 0; i < W; i++) {
+      maxError = fmaxf(maxError, fabsf(row[i * 3] - noise.GetNoise(1.5f + i * 0.3f, -2.0f)));
+    }
+    noise.GetNoiseRow(row.data(), W, 3, 1.5f, -2.0f, 9.0f, 0.3f);
+    for (int i = 0; i < W; i++) {
+      maxError =
+          fmaxf(maxError, fabsf(row[i * 3] - noise.GetNoise(1.5f + i * 0.3f, -2.0f, 9.0f)));
+    }
+
+    snprintf(message, sizeof(message), "%s, fractal type %d, max error %.1e", noiseNames[type],
+             fractal, maxError);
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT_MESSAGE(TOLERANCE, maxError, message);
+  }
+}
+
+static void test_single_octave() { checkType(FastNoiseLite::FractalType_None); }
+static void test_fbm() { checkType(FastNoiseLite::FractalType_FBm); }
+static void test_ridged() { checkType(FastNoiseLite::FractalType_Ridged); }
+static void test_ping_pong() { checkType(FastNoiseLite::FractalType_PingPong); }
+
+// As the noise effects sample it: 3D, one sample per pixel of the panel
+static void test_benchmark() {
+  const int w = 78, h = 78, frames = 20;
+  std::vector<float> frame(w * h);
+
+  for (int type = 0; type < 6; type++) {
+    FastNoiseLite noise = makeNoise(type, FastNoiseLite::FractalType_None);
+
+    double scalar = benchUs([&] {
+      for (int t = 0; t < frames; t++) {
+        for (int y = 0; y < h; y++) {
+          for (int x = 0; x < w; x++) {
+            frame[y * w + x] = noise.GetNoise((float)x, (float)y, (float)t);
+          }
+        }
+      }
+    });
+    double grid = benchUs([&] {
+      for (int t = 0; t < frames; t++) {
+        noise.GetNoiseGrid(frame.data(), w, h, w, 0.0f, 0.0f, (float)t, 1.0f, 1.0f);
+      }
+    });
+
+    const double pixels = (double)w * h * frames;
+    benchReport("FastNoise %s: GetNoise %.0f px/ms, grid %.0f px/ms", noiseNames[type],
+                pixels * 1000 / scalar, pixels * 1000 / grid);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_octave);
+  RUN_TEST(test_fbm);
+  RUN_TEST(test_ridged);
+  RUN_TEST(test_ping_pong);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// MBI_FrameEncoder against the per-pixel path it replaced: the greyscale
+// buffer mbi_set_pixel() and mbi_update_frame() used to build for the 78x78
+// panel, word for word, and how long each takes on the host.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "bench_timer.h"
+#include "mbi_frame_encoder.hpp"
+
+static const int ITERATIONS = 50;
+
+static uint8_t patternValue(uint16_t x, uint16_t y, uint8_t channel) {
+  uint32_t h = (x * 73856093u) ^ (y * 19349663u) ^ (channel * 83492791u);
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  return h >> 24;
+}
+
+// UMatrix::mbi_set_pixel() before the encoder, less the CIE table, transform()
+// and brightness, which now happen before a pixel reaches the framebuffer
+static void legacySetPixel(uint16_t* dma_grey_gpio_data, uint8_t x, uint8_t y, uint8_t r,
+                           uint8_t g, uint8_t b) {
+  int16_t _x = x, _y = y;
+  _x += 2;  // offset for missing pixels on the left
+
+  uint16_t _colourbitsoffset = (_y / PANEL_SCAN_LINES) * 3;
+  uint16_t _colourbitsclear = ~(0b111 << _colourbitsoffset);
+
+  uint16_t g_gpio_bitmask = BIT_G1 << _colourbitsoffset;
+  uint16_t b_gpio_bitmask = BIT_B1 << _colourbitsoffset;
+  uint16_t r_gpio_bitmask = BIT_R1 << _colourbitsoffset;
+
+  int y_normalised = _y % PANEL_SCAN_LINES;
+  int bit_start_pos = (1280 * y_normalised) + ((_x % 16) * 80) + ((_x / 16) * 16);
+
+  int subpixel_colour_bit = 8;
+  uint8_t mask;
+  while (subpixel_colour_bit > 0) {
+    subpixel_colour_bit--;
+    dma_grey_gpio_data[bit_start_pos] &= _colourbitsclear;
+
+    mask = 1 << subpixel_colour_bit;
+
+    if (g & mask) {
+      dma_grey_gpio_data[bit_start_pos] |= g_gpio_bitmask;
+    }
+    if (b & mask) {
+      dma_grey_gpio_data[bit_start_pos] |= b_gpio_bitmask;
+    }
+    if (r & mask) {
+      dma_grey_gpio_data[bit_start_pos] |= r_gpio_bitmask;
+    }
+
+    bit_start_pos++;
+  }
+}
+
+// The latches mbi_update_frame() added before sending
+static void legacyLatches(uint16_t* dma_grey_gpio_data) {
+  int counter = 0;
+  for (int row = 0; row < PANEL_SCAN_LINES; row++) {
+    for (int chan = 0; chan < PANEL_MBI_LED_CHANS; chan++) {
+      for (int ic = 0; ic < PANEL_MBI_CHAIN_LEN; ic++) {
+        int latch = ic == 4;
+        int bit_offset = 16;
+        while (bit_offset > 0) {
+          bit_offset--;
+          if (latch == 1 && bit_offset == 0) {
+            dma_grey_gpio_data[counter] |= BIT_LAT;
+          }
+          counter++;
+        }
+      }
+    }
+  }
+}
+
+static void legacyFrame(uint16_t* out, int frame) {
+  for (uint16_t y = 0; y < PANEL_RES_Y; y++) {
+    for (uint16_t x = 0; x < PANEL_RES_X; x++) {
+      legacySetPixel(out, x, y, patternValue(x + frame, y, 0), patternValue(x + frame, y, 1),
+                     patternValue(x + frame, y, 2));
+    }
+  }
+  legacyLatches(out);
+}
+
+static void storeFrame(const MBI_FrameEncoder& encoder, uint8_t* rgb, int frame) {
+  const MBI_PanelGeometry& g = encoder.getGeometry();
+  for (uint16_t y = 0; y < g.res_y; y++) {
+    for (uint16_t x = 0; x < g.res_x; x++) {
+      uint8_t* p = rgb + encoder.pixelIndex(x + g.offset_x, y + g.offset_y) * 3;
+      p[0] = patternValue(x + frame, y, 0);
+      p[1] = patternValue(x + frame, y, 1);
+      p[2] = patternValue(x + frame, y, 2);
+    }
+  }
+}
+
+static void test_matches_per_pixel_path() {
+  MBI_FrameEncoder encoder;  // default 78x78 panel, identity colour LUT
+  const size_t words = encoder.getGeometry().greyWords();
+  TEST_ASSERT_EQUAL_UINT(PANEL_SCAN_LINES * 1280, words);
+
+  std::vector<uint16_t> expected(words), encoded(words);
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3);
+  for (int frame = 0; frame < 3; frame++) {
+    std::fill(expected.begin(), expected.end(), 0);
+    legacyFrame(expected.data(), frame);
+    storeFrame(encoder, rgb.data(), frame);
+    encoder.encode(rgb.data(), encoded.data());
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(expected.data(), encoded.data(), words);
+  }
+}
+
+static void test_benchmark() {
+  MBI_FrameEncoder encoder;
+  const size_t words = encoder.getGeometry().greyWords();
+  std::vector<uint16_t> out(words);
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3);
+  storeFrame(encoder, rgb.data(), 0);
+
+  double perPixel = benchUs([&] {
+    for (int i = 0; i < ITERATIONS; i++) {
+      legacyFrame(out.data(), i);
+    }
+  });
+  double bulk = benchUs([&] {
+    for (int i = 0; i < ITERATIONS; i++) {
+      encoder.encode(rgb.data(), out.data());
+    }
+  });
+
+  benchReport("Frame encoder: per-pixel %.1f us, bulk %.1f us per frame", perPixel / ITERATIONS,
+              bulk / ITERATIONS);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_per_pixel_path);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
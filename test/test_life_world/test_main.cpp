@@ -0,0 +1,290 @@
+// LifeWorld against a cell by cell reference on the same torus, for Life-like
+// and Generations rules and for widths around the 64-bit word edges. Then
+// cell updates per second against the engine GameofLifeEffect used before.
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include "bench_timer.h"
+#include "LifeWorld.h"
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+// One byte per cell: 0 dead, 1 alive, k > 1 dying with k - 1 generations left
+struct ReferenceWorld {
+  int w, h;
+  LifeWorld::Rule rule;
+  std::vector<uint8_t> cells;
+
+  ReferenceWorld(int w, int h, const LifeWorld::Rule& rule)
+      : w(w), h(h), rule(rule), cells(w * h) {}
+
+  uint8_t& at(int x, int y) {
+    x = (x % w + w) % w;
+    y = (y % h + h) % h;
+    return cells[y * w + x];
+  }
+
+  void step() {
+    std::vector<uint8_t> next(cells.size());
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        int count = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+          for (int dx = -1; dx <= 1; dx++) {
+            if ((dx || dy) && at(x + dx, y + dy) == 1) {
+              count++;
+            }
+          }
+        }
+        uint8_t cell = at(x, y);
+        uint8_t& out = next[y * w + x];
+        if (cell == 1) {
+          out = (rule.survive >> count) & 1 ? 1 : (rule.states > 2 ? rule.states - 1 : 0);
+        } else if (cell > 1) {
+          out = cell == 2 ? 0 : cell - 1;
+        } else {
+          out = (rule.birth >> count) & 1;
+        }
+      }
+    }
+    cells.swap(next);
+  }
+};
+
+// GameofLifeEffect's engine before LifeWorld: a 4-byte cell per cell, eight
+// wrapped lookups for its neighbour count
+struct CellWorld {
+  struct Cell {
+    bool alive : 1;
+    bool prev : 1;
+    uint8_t hue : 6;
+    uint8_t brightness;
+  };
+  int w, h;
+  std::vector<std::vector<Cell>> world;
+
+  CellWorld(int w, int h) : w(w), h(h), world(w, std::vector<Cell>(h)) {}
+
+  int neighbours(int x, int y) {
+    return world[(x + 1) % w][y].prev + world[x][(y + 1) % h].prev +
+           world[(x + w - 1) % w][y].prev + world[x][(y + h - 1) % h].prev +
+           world[(x + 1) % w][(y + 1) % h].prev + world[(x + w - 1) % w][(y + 1) % h].prev +
+           world[(x + w - 1) % w][(y + h - 1) % h].prev + world[(x + 1) % w][(y + h - 1) % h].prev;
+  }
+
+  void step() {
+    for (int x = 0; x < w; x++) {
+      for (int y = 0; y < h; y++) {
+        Cell& c = world[x][y];
+        if (c.brightness > 0 && !c.prev)
+          c.brightness *= 0.9;
+        int count = neighbours(x, y);
+        if (count == 3 && !c.prev) {
+          c.alive = true;
+          c.hue += 2;
+          c.brightness = 255;
+        } else if ((count < 2 || count > 3) && c.prev) {
+          c.alive = false;
+        }
+      }
+    }
+    for (int x = 0; x < w; x++) {
+      for (int y = 0; y < h; y++) {
+        world[x][y].prev = world[x][y].alive;
+      }
+    }
+  }
+};
+
+static void test_parse_rules() {
+  LifeWorld::Rule rule;
+  TEST_ASSERT_TRUE(LifeWorld::parseRule("B36/S23", rule));
+  TEST_ASSERT_EQUAL_UINT16((1 << 3) | (1 << 6), rule.birth);
+  TEST_ASSERT_EQUAL_UINT16((1 << 2) | (1 << 3), rule.survive);
+  TEST_ASSERT_EQUAL_UINT8(2, rule.states);
+
+  TEST_ASSERT_TRUE(LifeWorld::parseRule("b2/s/c3", rule));  // Brian's Brain
+  TEST_ASSERT_EQUAL_UINT16(1 << 2, rule.birth);
+  TEST_ASSERT_EQUAL_UINT16(0, rule.survive);
+  TEST_ASSERT_EQUAL_UINT8(3, rule.states);
+
+  TEST_ASSERT_TRUE(LifeWorld::parseRule("345/2/4", rule));  // Golly's S/B/C
+  TEST_ASSERT_EQUAL_UINT16(1 << 2, rule.birth);
+  TEST_ASSERT_EQUAL_UINT16((1 << 3) | (1 << 4) | (1 << 5), rule.survive);
+  TEST_ASSERT_EQUAL_UINT8(4, rule.states);
+
+  const char* invalid[] = {"", "B9/S23", "B3/S23/C1", "B3/S23/C17", "hello", "B3/B3", "23", "B3"};
+  for (const char* text : invalid) {
+    LifeWorld::Rule kept;
+    kept.states = 5;
+    TEST_ASSERT_FALSE_MESSAGE(LifeWorld::parseRule(text, kept), text);
+    TEST_ASSERT_EQUAL_UINT8(5, kept.states);  // left alone
+  }
+}
+
+static void test_matches_reference() {
+  const char* rules[] = {"B3/S23",          "B36/S23",         "B2/S",      "B3678/S34678",
+                         "B1357/S1357",     "B0123478/S34678", "B2/S/C3",   "B2/S345/C4",
+                         "345/2/4",         "B2/S345/16",      "b1/s012345678/c7"};
+  const int sizes[][2] = {{1, 1}, {63, 10}, {64, 64}, {65, 7}, {130, 33}, {200, 50}, {64, 1}};
+  char message[96];
+
+  for (const char* text : rules) {
+    LifeWorld::Rule rule;
+    TEST_ASSERT_TRUE_MESSAGE(LifeWorld::parseRule(text, rule), text);
+
+    for (const auto& size : sizes) {
+      const int w = size[0], h = size[1];
+      LifeWorld world;
+      world.setRule(rule);
+      world.resize(w, h);
+      ReferenceWorld reference(w, h, rule);
+      for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+          bool alive = nextRandom() % 100 < 40;
+          world.set(x, y, alive);
+          reference.at(x, y) = alive;
+        }
+      }
+
+      uint32_t mismatches = 0;
+      for (int generation = 0; generation < 40; generation++) {
+        world.step();
+        reference.step();
+        for (int y = 0; y < h; y++) {
+          for (int x = 0; x < w; x++) {
+            uint8_t cell = reference.at(x, y);
+            if (world.alive(x, y) != (cell == 1) || world.dying(x, y) != (cell > 1 ? cell - 1 : 0)) {
+              mismatches++;
+            }
+          }
+        }
+      }
+      snprintf(message, sizeof(message), "%s on %dx%d", text, w, h);
+      TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, mismatches, message);
+      TEST_ASSERT_EQUAL_UINT32(40, world.generation());
+    }
+  }
+}
+
+static void test_multi_step_and_wrap() {
+  LifeWorld one, many;
+  one.resize(100, 40);
+  many.resize(100, 40);
+  for (int y = 0; y < 40; y++) {
+    for (int x = 0; x < 100; x++) {
+      bool alive = nextRandom() & 1;
+      one.set(x, y, alive);
+      many.set(x - 100, y + 40, alive);  // coordinates wrap
+    }
+  }
+  for (int i = 0; i < 25; i++) {
+    one.step();
+  }
+  many.step(25);
+  for (int y = 0; y < 40; y++) {
+    for (int x = 0; x < 100; x++) {
+      TEST_ASSERT_EQUAL(one.alive(x, y), many.alive(x, y));
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(one.population(), many.population());
+
+  many.clear();
+  TEST_ASSERT_EQUAL_UINT32(0, many.population());
+  TEST_ASSERT_EQUAL_UINT32(0, many.generation());
+}
+
+// A panel sized torus with a random soup, the same in both engines
+static void seedPanel(CellWorld& cells, LifeWorld& world, int w, int h) {
+  world.resize(w, h);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      bool alive = nextRandom() % 2;
+      cells.world[x][y] = {alive, alive, 0, (uint8_t)(alive ? 200 : 0)};
+      world.set(x, y, alive);
+    }
+  }
+}
+
+// The effect's old per-cell engine and LifeWorld agree on Conway's rule
+static void test_matches_cell_world() {
+  const int w = 78, h = 78, generations = 200;
+  CellWorld cells(w, h);
+  LifeWorld world;
+  seedPanel(cells, world, w, h);
+
+  for (int n = 0; n < generations; n++) {
+    cells.step();
+  }
+  world.step(generations);
+
+  uint32_t mismatches = 0;
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      if (cells.world[x][y].alive != world.alive(x, y)) {
+        mismatches++;
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// Conway's rule on a panel through both engines, then LifeWorld on a world of
+// 4 x 4 panels for Conway's rule and Brian's Brain
+static void test_benchmark() {
+  const int w = 78, h = 78, generations = 200;
+  CellWorld cells(w, h);
+  LifeWorld world;
+  seedPanel(cells, world, w, h);
+
+  double cellsTime = benchUs([&] {
+    for (int n = 0; n < generations; n++) {
+      cells.step();
+    }
+  });
+  double wordsTime = benchUs([&] { world.step(generations); });
+
+  LifeWorld large;
+  large.resize(w * 4, h * 4);
+  for (int y = 0; y < large.height(); y++) {
+    for (int x = 0; x < large.width(); x++) {
+      large.set(x, y, nextRandom() % 100 < 40);
+    }
+  }
+  double largeTime = benchUs([&] { large.step(generations); });
+
+  LifeWorld::Rule brain;
+  LifeWorld::parseRule("B2/S/C3", brain);
+  large.setRule(brain);
+  double brainTime = benchUs([&] { large.step(generations); });
+
+  const double updates = (double)w * h * generations;
+  const double largeUpdates = (double)large.width() * large.height() * generations;
+  benchReport("Life %dx%d: cells %.1f M updates/s, words %.1f M updates/s", w, h,
+              updates / cellsTime, updates / wordsTime);
+  benchReport("Life %ux%u: %.1f M updates/s, Brian's Brain %.1f M updates/s", large.width(),
+              large.height(), largeUpdates / largeTime, largeUpdates / brainTime);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_rules);
+  RUN_TEST(test_matches_reference);
+  RUN_TEST(test_multi_step_and_wrap);
+  RUN_TEST(test_matches_cell_world);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,392 @@
+// Frames encoded by MBI_FrameEncoder, played through the MBI5153 model as the
+// LCD peripheral would clock them out, have to come back pixel for pixel. Then
+// the words UMatrix sends around them: its init sequence and config registers,
+// its address map for every rotation and mirror mode, and the GCLK / address
+// line payload of the SPI loop.
+
+#include <unity.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "mbi_commands.hpp"
+#include "mbi_emulator.hpp"
+#include "mbi_frame_encoder.hpp"
+
+// The GCLK payload generator is plain C apart from its allocation and logging
+#define DMA_ATTR
+#define MALLOC_CAP_INTERNAL 0
+#define MALLOC_CAP_DMA 0
+#define heap_caps_malloc(size, caps) malloc(size)
+#define heap_caps_free(ptr) free(ptr)
+#define ESP_LOGI(...)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#include "spi_dma_seg_tx_payload.h"
+#pragma GCC diagnostic pop
+
+static uint32_t seed;
+
+static uint8_t nextByte() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed >> 24;
+}
+
+static MBI_PanelGeometry panel64() {
+  MBI_PanelGeometry g;
+  g.res_x = 64;
+  g.res_y = 64;
+  g.scan_lines = 16;
+  g.chain_len = 4;
+  g.offset_x = 0;
+  return g;
+}
+
+static MBI_PanelGeometry longChain() {
+  MBI_PanelGeometry g;
+  g.res_x = 126;
+  g.chain_len = 8;
+  return g;
+}
+
+static void vsync(MBI_Emulator& emulator) {
+  const uint16_t words[4] = {BIT_LAT, BIT_LAT, BIT_LAT, 0};
+  emulator.clockWords(words, 4);
+  emulator.endTransfer();
+}
+
+// One command buffer as its own transfer, as UMatrix sends them
+static void send(MBI_Emulator& emulator, const uint16_t* words, size_t count) {
+  emulator.busTap(words, count * sizeof(uint16_t), &emulator);
+  emulator.busTap(nullptr, 0, &emulator);
+}
+
+// A frame as UMatrix submits it: greyscale chain carrying on into the vsync
+static void present(MBI_Emulator& emulator, const std::vector<uint16_t>& grey) {
+  uint16_t v_sync[MBI_V_SYNC_LEN];
+  MBI_Commands::vSync(v_sync);
+  emulator.busTap(grey.data(), grey.size() * sizeof(uint16_t), &emulator);
+  emulator.busTap(v_sync, sizeof(v_sync), &emulator);
+  emulator.busTap(nullptr, 0, &emulator);
+}
+
+// UMatrix::updateRegisters() with the buffers from mbi_build_commands()
+static void initPanel(MBI_Emulator& emulator, const MBI_PanelGeometry& g,
+                      uint16_t reg1) {
+  uint16_t pre_active[MBI_PRE_ACTIVE_LEN];
+  uint16_t soft_reset[MBI_SOFT_RESET_LEN];
+  std::vector<uint16_t> config1(MBI_Commands::configWords(g));
+  std::vector<uint16_t> config2(MBI_Commands::configWords(g));
+  MBI_Commands::preActive(pre_active);
+  MBI_Commands::softReset(soft_reset);
+  MBI_Commands::config(config1.data(), g, reg1, false);
+  MBI_Commands::config(config2.data(), g, MBI_CONFIG_REG2_VALUE, true);
+
+  send(emulator, soft_reset, MBI_SOFT_RESET_LEN);
+  send(emulator, pre_active, MBI_PRE_ACTIVE_LEN);
+  send(emulator, config1.data(), config1.size());
+  send(emulator, pre_active, MBI_PRE_ACTIVE_LEN);
+  send(emulator, config2.data(), config2.size());
+  send(emulator, soft_reset, MBI_SOFT_RESET_LEN);
+}
+
+// Two frames in a row, so that the second vsync has to replace what the
+// first one put on the LEDs
+static void roundTrip(const MBI_PanelGeometry& g) {
+  TEST_ASSERT_TRUE(g.isValid());
+
+  MBI_FrameEncoder encoder(g);
+  uint16_t lut[3][256];
+  for (int c = 0; c < 3; c++) {
+    for (int i = 0; i < 256; i++) {
+      lut[c][i] = (i * 257 + c * 0x1234) & 0xFFFF;  // low bits set too
+    }
+  }
+  encoder.setColourLut(lut[0], lut[1], lut[2]);
+
+  MBI_Emulator emulator(g);
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3);
+  std::vector<uint16_t> grey(g.greyWords());
+
+  seed = 0x12345678 ^ g.chain_len;
+  for (int frame = 0; frame < 2; frame++) {
+    for (uint8_t& v : rgb) {
+      v = nextByte();
+    }
+    encoder.encode(rgb.data(), grey.data());
+    emulator.clockWords(grey.data(), grey.size());
+    emulator.endTransfer();
+    vsync(emulator);
+
+    uint32_t mismatches = 0;
+    for (uint16_t y = 0; y < g.mbiResY(); y++) {
+      for (uint16_t x = 0; x < g.mbiResX(); x++) {
+        const uint8_t* p = &rgb[encoder.pixelIndex(x, y) * 3];
+        for (int c = 0; c < 3; c++) {
+          if (emulator.shownGrey(x, y, c) != (lut[c][p[c]] & PANEL_GREY_MASK_14)) {
+            mismatches++;
+          }
+        }
+      }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+  }
+
+  const MBI_Emulator::Stats& stats = emulator.getStats();
+  TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+  TEST_ASSERT_EQUAL_UINT32(2 * g.scan_lines * PANEL_MBI_LED_CHANS, stats.data_latches);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.v_syncs);
+}
+
+static void test_round_trip_default_panel() { roundTrip(MBI_PanelGeometry()); }
+static void test_round_trip_64x64() { roundTrip(panel64()); }
+static void test_round_trip_long_chain() { roundTrip(longChain()); }
+
+// A frame latched only part way has no business being shown
+static void test_partial_frame_is_an_error() {
+  MBI_PanelGeometry g;
+  MBI_FrameEncoder encoder(g);
+  MBI_Emulator emulator(g);
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3, 0x80);
+  std::vector<uint16_t> grey(g.greyWords());
+  encoder.encode(rgb.data(), grey.data());
+
+  emulator.clockWords(grey.data(), grey.size() / 2);
+  emulator.endTransfer();
+  vsync(emulator);
+  TEST_ASSERT_EQUAL_UINT32(1, emulator.getStats().errors);
+}
+
+// A still picture is sent once by update(), then holdFrame() sends nothing
+// more while the layers don't draw. That one transfer has to leave the frame
+// on the LEDs, as does the single blank frame sent on power off.
+static void test_single_frame_is_shown() {
+  MBI_PanelGeometry g;
+  MBI_FrameEncoder encoder(g);
+  MBI_Emulator emulator(g);
+  initPanel(emulator, g, MBI_Commands::configReg1(g, MBI_ScanMode(), brightness_base));
+
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3);
+  std::vector<uint16_t> grey(g.greyWords());
+  seed = 0xC0FFEE;
+  for (uint8_t& v : rgb) {
+    v = nextByte() | 1;  // nothing black
+  }
+  encoder.encode(rgb.data(), grey.data());
+  present(emulator, grey);
+
+  uint32_t dark = 0;
+  for (uint16_t y = 0; y < g.mbiResY(); y++) {
+    for (uint16_t x = 0; x < g.mbiResX(); x++) {
+      for (int c = 0; c < 3; c++) {
+        if (emulator.shownGrey(x, y, c) == 0) {
+          dark++;
+        }
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, dark);
+  TEST_ASSERT_EQUAL_UINT32(1, emulator.getStats().v_syncs);
+
+  std::fill(rgb.begin(), rgb.end(), 0);
+  encoder.encode(rgb.data(), grey.data());
+  present(emulator, grey);
+
+  uint32_t lit = 0;
+  for (uint16_t y = 0; y < g.mbiResY(); y++) {
+    for (uint16_t x = 0; x < g.mbiResX(); x++) {
+      for (int c = 0; c < 3; c++) {
+        if (emulator.shownGrey(x, y, c) != 0) {
+          lit++;
+        }
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, lit);
+  TEST_ASSERT_EQUAL_UINT32(2, emulator.getStats().v_syncs);
+  TEST_ASSERT_EQUAL_UINT32(0, emulator.getStats().errors);
+}
+
+static void initSequence(const MBI_PanelGeometry& g, const MBI_ScanMode& mode,
+                         uint8_t gain) {
+  MBI_Emulator emulator(g);
+  uint16_t reg1 = MBI_Commands::configReg1(g, mode, gain);
+  initPanel(emulator, g, reg1);
+
+  const MBI_Emulator::Stats& stats = emulator.getStats();
+  TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+  TEST_ASSERT_TRUE(emulator.configConsistent());
+  TEST_ASSERT_EQUAL_HEX16(reg1, emulator.configReg1());
+  TEST_ASSERT_EQUAL_HEX16(MBI_CONFIG_REG2_VALUE, emulator.configReg2());
+  TEST_ASSERT_EQUAL_UINT32(2, stats.config_writes);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.soft_resets);
+  TEST_ASSERT_EQUAL_UINT32(6, stats.transfers);
+
+  // Scan lines, greyscale depth, multiplier and gain where the chips read them
+  TEST_ASSERT_EQUAL(g.scan_lines - 1, (reg1 >> 8) & 0x1F);
+  TEST_ASSERT_EQUAL(mode.grey_13bit, (reg1 >> 7) & 1);
+  TEST_ASSERT_EQUAL(mode.gclk_multiplier, (reg1 >> 6) & 1);
+  TEST_ASSERT_EQUAL(gain, reg1 & 0x3F);
+}
+
+static void test_init_sequence() {
+  MBI_ScanMode fast;
+  fast.gclk_multiplier = true;
+  fast.grey_13bit = true;
+  initSequence(MBI_PanelGeometry(), MBI_ScanMode(), brightness_base);
+  initSequence(MBI_PanelGeometry(), fast, current_gain_min);
+  initSequence(panel64(), MBI_ScanMode(), 20);
+  initSequence(longChain(), fast, 0);
+}
+
+// Without a pre-active first the chips ignore a config write
+static void test_config_needs_pre_active() {
+  MBI_PanelGeometry g;
+  MBI_Emulator emulator(g);
+  std::vector<uint16_t> config1(MBI_Commands::configWords(g));
+  MBI_Commands::config(config1.data(), g, 0x1234, false);
+  send(emulator, config1.data(), config1.size());
+  TEST_ASSERT_EQUAL_UINT32(1, emulator.getStats().errors);
+  TEST_ASSERT_EQUAL_HEX16(0, emulator.configReg1());
+}
+
+static uint8_t patternValue(int x, int y, int c) {
+  uint32_t h = (x * 73856093u) ^ (y * 19349663u) ^ (c * 83492791u);
+  h ^= h >> 13;
+  return (h * 0x5bd1e995u) >> 24;
+}
+
+// Drawn through the address map UMatrix builds, every pixel has to light the
+// LED the rotation and mirroring put it on, and no other
+static void rotations(const MBI_PanelGeometry& g) {
+  MBI_FrameEncoder encoder(g);
+  MBI_Emulator emulator(g);
+  initPanel(emulator, g, MBI_Commands::configReg1(g, MBI_ScanMode(), brightness_base));
+
+  uint16_t lut[3][256];
+  for (int c = 0; c < 3; c++) {
+    for (int i = 0; i < 256; i++) {
+      lut[c][i] = i << 8;
+    }
+  }
+  encoder.setColourLut(lut[0], lut[1], lut[2]);
+
+  std::vector<uint16_t> map(g.res_x * g.res_y);
+  std::vector<uint8_t> rgb((encoder.pixelCount() + 1) * 3);
+  std::vector<uint16_t> grey(g.greyWords());
+
+  for (int mode = 0; mode < 8; mode++) {
+    uint8_t rotation = mode & 3;
+    bool mirror_x = mode & 4;
+    encoder.buildAddressMap(map.data(), rotation, mirror_x, false);
+
+    std::fill(rgb.begin(), rgb.end(), 0);
+    std::vector<uint16_t> expected(g.mbiResX() * g.mbiResY() * 3, 0);
+    for (int y = 0; y < g.res_y; y++) {
+      for (int x = 0; x < g.res_x; x++) {
+        uint8_t* p = &rgb[map[y * g.res_x + x] * 3];
+        for (int c = 0; c < 3; c++) {
+          p[c] = patternValue(x, y, mode + c);
+        }
+
+        // Where the pixel belongs: mirrored, then turned clockwise
+        int px = mirror_x ? g.res_x - 1 - x : x, py = y;
+        int rx = px, ry = py;
+        if (rotation == 1) {
+          rx = py;
+          ry = g.res_x - 1 - px;
+        } else if (rotation == 2) {
+          rx = g.res_x - 1 - px;
+          ry = g.res_y - 1 - py;
+        } else if (rotation == 3) {
+          rx = g.res_y - 1 - py;
+          ry = px;
+        }
+        if (rx < 0 || ry < 0 || rx >= g.res_x || ry >= g.res_y) {
+          continue;
+        }
+        size_t led = (ry + g.offset_y) * g.mbiResX() + rx + g.offset_x;
+        for (int c = 0; c < 3; c++) {
+          expected[led * 3 + c] = lut[c][p[c]] & PANEL_GREY_MASK_14;
+        }
+      }
+    }
+
+    encoder.encode(rgb.data(), grey.data());
+    present(emulator, grey);
+
+    uint32_t mismatches = 0;
+    for (uint16_t y = 0; y < g.mbiResY(); y++) {
+      for (uint16_t x = 0; x < g.mbiResX(); x++) {
+        for (int c = 0; c < 3; c++) {
+          if (emulator.shownGrey(x, y, c) != expected[(y * g.mbiResX() + x) * 3 + c]) {
+            mismatches++;
+          }
+        }
+      }
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, mismatches, mode & 4 ? "mirrored" : "not mirrored");
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, emulator.getStats().errors);
+  TEST_ASSERT_EQUAL_UINT32(8, emulator.getStats().v_syncs);
+}
+
+static MBI_PanelGeometry widePanel() {
+  MBI_PanelGeometry g;
+  g.res_x = 78;
+  g.res_y = 40;
+  return g;
+}
+
+static void test_rotations_default_panel() { rotations(MBI_PanelGeometry()); }
+static void test_rotations_64x64() { rotations(panel64()); }
+static void test_rotations_wide_panel() { rotations(widePanel()); }
+
+// The payload spi_setup() / spi_set_gclks_per_row() generate, for both GCLK
+// counts the scan modes use
+static void test_gclk_payload() {
+  const MBI_PanelGeometry geometries[] = {MBI_PanelGeometry(), panel64()};
+  for (const MBI_PanelGeometry& g : geometries) {
+    for (int gclks : {gclk_per_row, gclk_per_row_multiplied}) {
+      allocate_gclk_dma_memory(g.scan_lines, gclks);
+      TEST_ASSERT_EQUAL(g.gclkPayloadBytes(gclks), gclk_total_size);
+
+      MBI_Emulator emulator(g);
+      TEST_ASSERT_TRUE(emulator.checkGclkPayload(spi_tx_octal_payload, gclk_total_size, gclks));
+      TEST_ASSERT_FALSE(emulator.checkGclkPayload(spi_tx_octal_payload, gclk_total_size,
+                                                  gclks == gclk_per_row ? gclk_per_row_multiplied
+                                                                        : gclk_per_row));
+
+      // One GCLK short on a scan line
+      spi_tx_octal_payload[8 + 2] &= ~0x80;
+      TEST_ASSERT_FALSE(emulator.checkGclkPayload(spi_tx_octal_payload, gclk_total_size, gclks));
+    }
+  }
+  heap_caps_free(spi_tx_octal_payload);
+  spi_tx_octal_payload = NULL;
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_default_panel);
+  RUN_TEST(test_round_trip_64x64);
+  RUN_TEST(test_round_trip_long_chain);
+  RUN_TEST(test_partial_frame_is_an_error);
+  RUN_TEST(test_single_frame_is_shown);
+  RUN_TEST(test_init_sequence);
+  RUN_TEST(test_config_needs_pre_active);
+  RUN_TEST(test_rotations_default_panel);
+  RUN_TEST(test_rotations_64x64);
+  RUN_TEST(test_rotations_wide_panel);
+  RUN_TEST(test_gclk_payload);
+  return UNITY_END();
+}
@@ -0,0 +1,217 @@
+// inoise8Row() and inoise8Tile() against FastLED's inoise8(), sample for
+// sample. The reference below is FastLED's noise.cpp (the portable C path)
+// with the helpers it uses from lib8tion, so the test runs without FastLED.
+
+#include <unity.h>
+
+#include <vector>
+
+#include "bench_timer.h"
+#include "Noise8.hpp"
+
+static const uint8_t p[257] = {
+    151, 160, 137, 91,  90,  15,  131, 13,  201, 95,  96,  53,  194, 233, 7,   225, 140, 36,
+    103, 30,  69,  142, 8,   99,  37,  240, 21,  10,  23,  190, 6,   148, 247, 120, 234, 75,
+    0,   26,  197, 62,  94,  252, 219, 203, 117, 35,  11,  32,  57,  177, 33,  88,  237, 149,
+    56,  87,  174, 20,  125, 136, 171, 168, 68,  175, 74,  165, 71,  134, 139, 48,  27,  166,
+    77,  146, 158, 231, 83,  111, 229, 122, 60,  211, 133, 230, 220, 105, 92,  41,  55,  46,
+    245, 40,  244, 102, 143, 54,  65,  25,  63,  161, 1,   216, 80,  73,  209, 76,  132, 187,
+    208, 89,  18,  169, 200, 196, 135, 130, 116, 188, 159, 86,  164, 100, 109, 198, 173, 186,
+    3,   64,  52,  217, 226, 250, 124, 123, 5,   202, 38,  147, 118, 126, 255, 82,  85,  212,
+    207, 206, 59,  227, 47,  16,  58,  17,  182, 189, 28,  42,  223, 183, 170, 213, 119, 248,
+    152, 2,   44,  154, 163, 70,  221, 153, 101, 155, 167, 43,  172, 9,   129, 22,  39,  253,
+    19,  98,  108, 110, 79,  113, 224, 232, 178, 185, 112, 104, 218, 246, 97,  228, 251, 34,
+    242, 193, 238, 210, 144, 12,  191, 179, 162, 241, 81,  51,  145, 235, 249, 14,  239, 107,
+    49,  192, 214, 31,  181, 199, 106, 157, 184, 84,  204, 176, 115, 121, 50,  45,  127, 4,
+    150, 254, 138, 236, 205, 93,  222, 114, 67,  29,  24,  72,  243, 141, 128, 195, 78,  66,
+    215, 61,  156, 180, 151};
+
+static uint8_t scale8(uint8_t i, uint8_t scale) { return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8; }
+
+static uint8_t qadd8(uint8_t i, uint8_t j) {
+  unsigned t = i + j;
+  return t > 255 ? 255 : t;
+}
+
+static int8_t avg7(int8_t i, int8_t j) { return (i >> 1) + (j >> 1) + (i & 0x1); }
+
+static uint8_t ease8InOutQuad(uint8_t i) {
+  uint8_t j = i;
+  if (j & 0x80) {
+    j = 255 - j;
+  }
+  uint8_t jj = scale8(j, j);
+  uint8_t jj2 = jj << 1;
+  if (i & 0x80) {
+    jj2 = 255 - jj2;
+  }
+  return jj2;
+}
+
+static int8_t lerp7by8(int8_t a, int8_t b, uint8_t frac) {
+  if (b > a) {
+    uint8_t delta = b - a;
+    return a + scale8(delta, frac);
+  }
+  uint8_t delta = a - b;
+  return a - scale8(delta, frac);
+}
+
+static int8_t grad8(uint8_t hash, int8_t x, int8_t y, int8_t z) {
+  hash = hash & 0xF;
+  int8_t u = (hash & 8) ? y : x;
+  int8_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x : z;
+  if (hash & 1) {
+    u = -u;
+  }
+  if (hash & 2) {
+    v = -v;
+  }
+  return avg7(u, v);
+}
+
+static int8_t inoise8_raw(uint16_t x, uint16_t y, uint16_t z) {
+  uint8_t X = x >> 8;
+  uint8_t Y = y >> 8;
+  uint8_t Z = z >> 8;
+
+  uint8_t A = p[X] + Y;
+  uint8_t AA = p[A] + Z;
+  uint8_t AB = p[A + 1] + Z;
+  uint8_t B = p[X + 1] + Y;
+  uint8_t BA = p[B] + Z;
+  uint8_t BB = p[B + 1] + Z;
+
+  uint8_t u = ease8InOutQuad(x);
+  uint8_t v = ease8InOutQuad(y);
+  uint8_t w = ease8InOutQuad(z);
+
+  int8_t xx = ((uint8_t)x >> 1) & 0x7F;
+  int8_t yy = ((uint8_t)y >> 1) & 0x7F;
+  int8_t zz = ((uint8_t)z >> 1) & 0x7F;
+  uint8_t N = 0x80;
+
+  int8_t X1 = lerp7by8(grad8(p[AA], xx, yy, zz), grad8(p[BA], xx - N, yy, zz), u);
+  int8_t X2 = lerp7by8(grad8(p[AB], xx, yy - N, zz), grad8(p[BB], xx - N, yy - N, zz), u);
+  int8_t X3 = lerp7by8(grad8(p[AA + 1], xx, yy, zz - N), grad8(p[BA + 1], xx - N, yy, zz - N), u);
+  int8_t X4 = lerp7by8(grad8(p[AB + 1], xx, yy - N, zz - N),
+                       grad8(p[BB + 1], xx - N, yy - N, zz - N), u);
+
+  int8_t Y1 = lerp7by8(X1, X2, v);
+  int8_t Y2 = lerp7by8(X3, X4, v);
+  return lerp7by8(Y1, Y2, w);
+}
+
+static uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z) {
+  int8_t n = inoise8_raw(x, y, z);  // -64..+64
+  n += 64;                          //   0..128
+  return qadd8(n, n);               //   0..255
+}
+
+static uint32_t seed = 1;
+
+static uint16_t next16() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed >> 16;
+}
+
+// About 30M samples: rows at random coordinates, with steps from a fraction
+// of a cell (the effects' case) to several cells and wrapping past 16 bits
+static void test_rows_match_inoise8() {
+  uint8_t out[300];
+  uint32_t mismatches = 0;
+  uint32_t samples = 0;
+  for (int n = 0; n < 200000; n++) {
+    uint16_t x = next16();
+    uint16_t y = next16();
+    uint16_t z = next16();
+    uint16_t step = n % 3 ? next16() % 64 : next16();
+    size_t count = 1 + next16() % 300;
+    inoise8Row(out, count, x, step, y, z);
+    for (size_t i = 0; i < count; i++) {
+      if (out[i] != inoise8(x + i * step, y, z)) {
+        mismatches++;
+      }
+    }
+    samples += count;
+  }
+  TEST_ASSERT_GREATER_THAN(29000000, samples);
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// Every x of the 16-bit range, for a few rows
+static void test_full_x_range() {
+  std::vector<uint8_t> out(65536);
+  uint32_t mismatches = 0;
+  for (int n = 0; n < 16; n++) {
+    uint16_t y = next16();
+    uint16_t z = next16();
+    inoise8Row(out.data(), out.size(), 0, 1, y, z);
+    for (uint32_t x = 0; x < 65536; x++) {
+      if (out[x] != inoise8(x, y, z)) {
+        mismatches++;
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// A NoiseEffect frame, scale 15, with the tile written into a wider buffer
+static void test_tile_matches_inoise8() {
+  const int w = 78, h = 78, stride = 80, scale = 15;
+  std::vector<uint8_t> tile(stride * h, 0xA5);
+  uint32_t mismatches = 0;
+  for (int t = 0; t < 20; t++) {
+    inoise8Tile(tile.data(), stride, w, h, 1000, scale, 2000, scale, t * 100);
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < stride; x++) {
+        uint8_t expected = x < w ? inoise8(1000 + x * scale, 2000 + y * scale, t * 100) : 0xA5;
+        if (tile[y * stride + x] != expected) {
+          mismatches++;
+        }
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+static void test_benchmark() {
+  const int w = 78, h = 78, scale = 15, frames = 200;
+  std::vector<uint8_t> frame(w * h);
+  unsigned sum = 0;
+
+  double scalar = benchUs([&] {
+    for (int t = 0; t < frames; t++) {
+      for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+          frame[y * w + x] = inoise8(x * scale, y * scale, t * 100);
+        }
+      }
+      sum += frame[t % (w * h)];
+    }
+  });
+  double rows = benchUs([&] {
+    for (int t = 0; t < frames; t++) {
+      inoise8Tile(frame.data(), w, w, h, 0, scale, 0, scale, t * 100);
+      sum += frame[t % (w * h)];
+    }
+  });
+
+  const double pixels = (double)w * h * frames;
+  benchReport("Noise %dx%d: inoise8 %.0f px/ms, rows %.0f px/ms (%u)", w, h,
+              pixels * 1000 / scalar, pixels * 1000 / rows, sum);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rows_match_inoise8);
+  RUN_TEST(test_full_x_range);
+  RUN_TEST(test_tile_matches_inoise8);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
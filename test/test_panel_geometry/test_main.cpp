@@ -0,0 +1,144 @@
+// MBI_PanelGeometry limits, and the greyscale buffer layout the encoder
+// produces for several geometries against the MBI5153 data order written out
+// longhand: per scan line, channel by channel, each channel shifted through
+// the whole chain, 16 bits MSB first.
+
+#include <unity.h>
+
+#include <vector>
+
+#include "mbi_frame_encoder.hpp"
+#include "mbi_panel_geometry.hpp"
+
+static MBI_PanelGeometry geometry(uint16_t res_x, uint16_t res_y, uint8_t scan_lines,
+                                  uint8_t chain_len, uint8_t offset_x) {
+  MBI_PanelGeometry g;
+  g.res_x = res_x;
+  g.res_y = res_y;
+  g.scan_lines = scan_lines;
+  g.chain_len = chain_len;
+  g.offset_x = offset_x;
+  return g;
+}
+
+static uint8_t patternValue(uint16_t x, uint16_t y, uint8_t channel) {
+  uint32_t h = (x * 73856093u) ^ (y * 19349663u) ^ (channel * 83492791u);
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  return h >> 24;
+}
+
+static void test_default_geometry() {
+  MBI_PanelGeometry g;
+  TEST_ASSERT_TRUE(g.isValid());
+  TEST_ASSERT_EQUAL_UINT(80, g.mbiResX());
+  TEST_ASSERT_EQUAL_UINT(80, g.mbiResY());
+  TEST_ASSERT_EQUAL_UINT(80 * 16 * 20, g.greyWords());  // 1280 words per scan line
+  TEST_ASSERT_EQUAL_UINT(0xFFFFF, g.allRows());
+}
+
+static void test_invalid_geometries() {
+  TEST_ASSERT_FALSE(geometry(0, 78, 20, 5, 2).isValid());
+  TEST_ASSERT_FALSE(geometry(79, 78, 20, 5, 2).isValid());  // past the chain with the offset
+  TEST_ASSERT_FALSE(geometry(78, 81, 20, 5, 2).isValid());  // more rows than 4 lanes scan
+  TEST_ASSERT_FALSE(geometry(78, 78, 0, 5, 2).isValid());
+  TEST_ASSERT_FALSE(geometry(78, 78, 33, 5, 2).isValid());
+  TEST_ASSERT_FALSE(geometry(78, 78, 20, 0, 2).isValid());
+  TEST_ASSERT_FALSE(geometry(78, 78, 20, 9, 2).isValid());
+  // 32 scan lines of 513 GCLKs don't fit one SPI segment, with the
+  // multiplier's 257 they do
+  TEST_ASSERT_FALSE(geometry(64, 128, 32, 4, 0).isValid(gclk_per_row));
+  TEST_ASSERT_TRUE(geometry(64, 128, 32, 4, 0).isValid(gclk_per_row_multiplied));
+}
+
+// Every addressable pixel has a framebuffer slot of its own
+static void checkSlots(const MBI_PanelGeometry& g) {
+  MBI_FrameEncoder encoder(g);
+  std::vector<bool> used(encoder.pixelCount());
+  for (uint16_t y = 0; y < g.mbiResY(); y++) {
+    for (uint16_t x = 0; x < g.mbiResX(); x++) {
+      size_t slot = encoder.pixelIndex(x, y);
+      TEST_ASSERT_TRUE(slot < used.size());
+      TEST_ASSERT_FALSE(used[slot]);
+      used[slot] = true;
+    }
+  }
+}
+
+static void checkLayout(const MBI_PanelGeometry& g) {
+  TEST_ASSERT_TRUE(g.isValid());
+  MBI_FrameEncoder encoder(g);  // identity colour LUT, v << 8
+  const size_t words = g.greyWords();
+  std::vector<uint8_t> rgb(encoder.pixelCount() * 3);
+  std::vector<uint16_t> expected(words), encoded(words);
+
+  for (uint16_t y = 0; y < g.mbiResY(); y++) {
+    for (uint16_t x = 0; x < g.mbiResX(); x++) {
+      uint8_t* p = &rgb[encoder.pixelIndex(x, y) * 3];
+      uint16_t value[3];
+      for (int c = 0; c < 3; c++) {
+        p[c] = patternValue(x, y, c);
+        value[c] = p[c] << 8;
+      }
+
+      size_t pos = (y % g.scan_lines) * g.rowWords() +
+                   (x % PANEL_MBI_LED_CHANS) * g.chain_len * 16 +
+                   (x / PANEL_MBI_LED_CHANS) * 16;
+      int lane = y / g.scan_lines;
+      for (int bit = 15; bit >= 0; bit--, pos++) {
+        if (value[1] & (1 << bit)) expected[pos] |= BIT_G1 << (lane * 3);
+        if (value[2] & (1 << bit)) expected[pos] |= BIT_B1 << (lane * 3);
+        if (value[0] & (1 << bit)) expected[pos] |= BIT_R1 << (lane * 3);
+      }
+    }
+  }
+  for (size_t pos = g.chain_len * 16 - 1; pos < words; pos += g.chain_len * 16) {
+    expected[pos] |= BIT_LAT;
+  }
+
+  encoder.encode(rgb.data(), encoded.data());
+  TEST_ASSERT_EQUAL_HEX16_ARRAY(expected.data(), encoded.data(), words);
+
+  // Only the rows asked for are touched
+  std::vector<uint16_t> partial(words, 0xAAAA);
+  encoder.encodeRows(rgb.data(), partial.data(), 0x5);
+  for (size_t i = 0; i < words; i++) {
+    size_t row = i / g.rowWords();
+    uint16_t want = (row == 0 || row == 2) ? expected[i] : 0xAAAA;
+    TEST_ASSERT_EQUAL_HEX16(want, partial[i]);
+  }
+}
+
+static void test_default_panel_layout() {
+  checkSlots(MBI_PanelGeometry());
+  checkLayout(MBI_PanelGeometry());
+}
+
+static void test_64x64_layout() {
+  checkSlots(geometry(64, 64, 16, 4, 0));
+  checkLayout(geometry(64, 64, 16, 4, 0));
+}
+
+static void test_longest_chain_layout() {
+  checkSlots(geometry(126, 78, 20, 8, 2));
+  checkLayout(geometry(126, 78, 20, 8, 2));
+}
+
+static void test_32x32_layout() {
+  checkSlots(geometry(32, 32, 8, 2, 0));
+  checkLayout(geometry(32, 32, 8, 2, 0));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_default_geometry);
+  RUN_TEST(test_invalid_geometries);
+  RUN_TEST(test_default_panel_layout);
+  RUN_TEST(test_64x64_layout);
+  RUN_TEST(test_longest_chain_layout);
+  RUN_TEST(test_32x32_layout);
+  return UNITY_END();
+}
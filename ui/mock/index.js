@@ -41,6 +41,7 @@ const state = {
     text: {
         payload: "Hello! 12345",
         size: 0,
+        speed: 0,
     },
     settings: {
         mqtt: {
@@ -176,6 +177,23 @@ export default [
             }
         }
     },
+    {
+        url: '/openmatrix/effect/settings',
+        method: 'post',
+        timeout: 1000,
+        response: async ({ body }) => {
+            state.effects[body.effectId] = {
+                ...state.effects[body.effectId],
+                ...body.settings,
+            };
+            return {
+                code: 200,
+                data: {
+                    message: 'OK'
+                }
+            }
+        }
+    },
     {
         url: '/openmatrix/image',
         method: 'get',
@@ -218,6 +236,7 @@ export default [
         response: async ({ body }) => {
             state.text.payload = body.payload;
             state.text.size = body.size;
+            state.text.speed = body.speed;
 
             return {
                 code: 200,
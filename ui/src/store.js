@@ -383,13 +383,14 @@ async function convertToGif(file, width, height) {
   });
 }
 
-export const updateText = async ({ payload, size }) => {
+export const updateText = async ({ payload, size, speed }) => {
   const response = await fetchWithTimeout(`${API_URL}/openmatrix/text`, {
     method: "POST",
     timeout: 2000,
     body: JSON.stringify({
       payload,
       size,
+      speed,
     }),
   });
   if (response.status === 200) {
@@ -399,6 +400,7 @@ export const updateText = async ({ payload, size }) => {
       text: {
         payload,
         size,
+        speed,
       },
     });
   }